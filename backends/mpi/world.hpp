@@ -6,6 +6,7 @@
 #include <bulk/messages.hpp>
 #include <bulk/variable.hpp>
 #include <bulk/world.hpp>
+#include <climits>
 #include <iostream>
 #include <map>
 #include <string>
@@ -25,6 +26,9 @@ enum class message_t : int {
   send_custom
 };
 
+// The layout of the elements of a put or get record
+enum class layout_t : int { contiguous, block, indexed };
+
 class world : public bulk::world {
  public:
   world(MPI_Comm communicator = MPI_COMM_WORLD)
@@ -46,6 +50,7 @@ class world : public bulk::world {
   }
 
   virtual ~world() {
+    release_workspace_();
     if (communicator_ != MPI_COMM_WORLD) {
       MPI_Comm_free(&communicator_);
     }
@@ -55,6 +60,13 @@ class world : public bulk::world {
   int rank() const override final { return processor_id_; }
 
   void sync(bool clear_queues = true) override final {
+    // Queues that hold back messages send them now
+    for (auto q : queues_) {
+      if (q) {
+        q->flush_();
+      }
+    }
+
     if (clear_queues) {
       clear_messages_();
     }
@@ -216,12 +228,50 @@ class world : public bulk::world {
   void put_(int processor, const void* values, size_t size, int var_id,
             size_t offset, size_t count) override final {
     put_buffers_[processor] << var_id;
+    put_buffers_[processor] << layout_t::contiguous;
     size_t total_offset = offset * size;
     put_buffers_[processor] << total_offset;
     put_buffers_[processor] << (size_t)(size * count);
     put_buffers_[processor].push(size * count, values);
   }
 
+  // Strided, block and indexed puts are packed into a single record, and
+  // unpacked by the receiver
+  void put_strided_(int processor, const void* values, size_t size,
+                    size_t src_stride, int var_id, size_t offset, size_t stride,
+                    size_t count) override final {
+    put_block_(processor, values, size,
+               detail::block_layout::strided(0, src_stride, count), var_id,
+               detail::block_layout::strided(offset, stride, count));
+  }
+
+  void put_block_(int processor, const void* values, size_t size,
+                  const detail::block_layout& src, int var_id,
+                  const detail::block_layout& dst) override final {
+    auto& buffer = put_buffers_[processor];
+    auto count = src.count();
+    buffer << var_id;
+    buffer << layout_t::block;
+    buffer << size;
+    buffer << dst;
+    buffer.ensure_room(size * count);
+    detail::copy_block((const char*)values, src, buffer.buffer(),
+                       detail::block_layout::packed(src), size);
+    buffer.update(size * count);
+  }
+
+  void put_indexed_(int processor, const void* values, size_t size,
+                    int var_id, const size_t* indices,
+                    size_t count) override final {
+    auto& buffer = put_buffers_[processor];
+    buffer << var_id;
+    buffer << layout_t::indexed;
+    buffer << size;
+    buffer << count;
+    buffer.push(count * sizeof(size_t), indices);
+    buffer.push(count * size, values);
+  }
+
   void get_buffer_(int target, int var_id,
                    class future_base* future) override final {
     auto& buffer = custom_get_request_buffers_[target];
@@ -234,6 +284,7 @@ class world : public bulk::world {
   void get_(int processor, int var_id, size_t size, void* target, size_t offset,
             size_t count) override final {
     get_request_buffers_[processor] << var_id;
+    get_request_buffers_[processor] << layout_t::contiguous;
     size_t total_offset = offset * size;
     get_request_buffers_[processor] << total_offset;
     get_request_buffers_[processor] << (size_t)(size * count);
@@ -241,6 +292,29 @@ class world : public bulk::world {
     get_request_buffers_[processor] << processor_id_;
   }
 
+  void get_indexed_(int processor, int var_id, size_t size, void* target,
+                    const size_t* indices, size_t count) override final {
+    auto& buffer = get_request_buffers_[processor];
+    buffer << var_id;
+    buffer << layout_t::indexed;
+    buffer << size;
+    buffer << count;
+    buffer << target;
+    buffer << processor_id_;
+    buffer.push(count * sizeof(size_t), indices);
+  }
+
+  void get_block_(int processor, int var_id, size_t size, void* target,
+                  const detail::block_layout& src) override final {
+    auto& buffer = get_request_buffers_[processor];
+    buffer << var_id;
+    buffer << layout_t::block;
+    buffer << size;
+    buffer << target;
+    buffer << processor_id_;
+    buffer << src;
+  }
+
   // Messages
   int register_queue_(queue_base* q) override {
     auto idx = 0u;
@@ -268,11 +342,72 @@ class world : public bulk::world {
     return loc;
   }
 
+  bool allreduce_(void* values, size_t count, scalar_type type,
+                  reduce_op op) override final {
+    if (count > INT_MAX) {
+      return false;
+    }
+    sync();
+    MPI_Allreduce(MPI_IN_PLACE, values, count, mpi_type_(type), mpi_op_(op),
+                  communicator_);
+    return true;
+  }
+
+  bool broadcast_(void* values, size_t size, int root) override final {
+    if (size > INT_MAX) {
+      return false;
+    }
+    sync();
+    MPI_Bcast(values, size, MPI_BYTE, root, communicator_);
+    return true;
+  }
+
+  bool allgather_(const void* value, void* result,
+                  size_t size) override final {
+    if (size > INT_MAX) {
+      return false;
+    }
+    sync();
+    MPI_Allgather(value, size, MPI_BYTE, result, size, MPI_BYTE,
+                  communicator_);
+    return true;
+  }
+
   void log_(std::string message) override final {
     printf("$%i (%s): %s\n", processor_id_, name_, message.c_str());
   }
 
  private:
+  static MPI_Datatype mpi_type_(scalar_type type) {
+    switch (type) {
+      case scalar_type::int32:
+        return MPI_INT32_T;
+      case scalar_type::uint32:
+        return MPI_UINT32_T;
+      case scalar_type::int64:
+        return MPI_INT64_T;
+      case scalar_type::uint64:
+        return MPI_UINT64_T;
+      case scalar_type::float32:
+        return MPI_FLOAT;
+      default:
+        return MPI_DOUBLE;
+    }
+  }
+
+  static MPI_Op mpi_op_(reduce_op op) {
+    switch (op) {
+      case reduce_op::sum:
+        return MPI_SUM;
+      case reduce_op::product:
+        return MPI_PROD;
+      case reduce_op::min:
+        return MPI_MIN;
+      default:
+        return MPI_MAX;
+    }
+  }
+
   bool send_single_buffer_(memory_buffer& buf, message_t tag, int processor) {
     // start sending put buffers
     if (buf.size() > 0) {
@@ -316,15 +451,39 @@ class world : public bulk::world {
     auto reader = buf.reader();
     while (!reader.empty()) {
       int var_id = 0;
-      size_t offset = 0;
-      size_t size = 0;
-
+      auto layout = layout_t::contiguous;
       reader >> var_id;
-      reader >> offset;
-      reader >> size;
-
-      auto write_location = (char*)locations_[var_id] + offset;
-      reader.copy(size, write_location);
+      reader >> layout;
+      auto location = (char*)locations_[var_id];
+
+      if (layout == layout_t::contiguous) {
+        size_t offset = 0;
+        size_t size = 0;
+        reader >> offset;
+        reader >> size;
+        reader.copy(size, location + offset);
+      } else if (layout == layout_t::block) {
+        size_t size = 0;
+        auto dst = detail::block_layout{};
+        reader >> size;
+        reader >> dst;
+        detail::copy_block(reader.current_location(),
+                           detail::block_layout::packed(dst), location, dst,
+                           size);
+        reader.update(size * dst.count());
+      } else {
+        size_t size = 0;
+        size_t count = 0;
+        reader >> size;
+        reader >> count;
+        auto indices = reader.current_location();
+        reader.update(count * sizeof(size_t));
+        for (size_t i = 0; i < count; ++i) {
+          size_t idx = 0;
+          memcpy(&idx, indices + i * sizeof(size_t), sizeof(size_t));
+          reader.copy(size, location + idx * size);
+        }
+      }
     }
     buf.clear();
   }
@@ -362,12 +521,24 @@ class world : public bulk::world {
     auto reader = buf.reader();
     while (!reader.empty()) {
       int var_id = 0;
+      auto layout = layout_t::contiguous;
+      reader >> var_id;
+      reader >> layout;
+
+      if (layout == layout_t::indexed) {
+        send_indexed_get_response_(reader, var_id);
+        continue;
+      }
+      if (layout == layout_t::block) {
+        send_block_get_response_(reader, var_id);
+        continue;
+      }
+
       void* target = 0;
       int processor = 0;
       size_t offset = 0;
       size_t size = 0;
 
-      reader >> var_id;
       reader >> offset;
       reader >> size;
       reader >> target;
@@ -383,6 +554,56 @@ class world : public bulk::world {
     send_buffers_(get_response_buffers_, message_t::get_response, got_sent);
   }
 
+  // The response to an indexed get is a contiguous one, with the elements
+  // packed in the order of the indices
+  void send_indexed_get_response_(memory_buffer::memory_reader& reader,
+                                  int var_id) {
+    size_t size = 0;
+    size_t count = 0;
+    void* target = nullptr;
+    int processor = 0;
+    reader >> size;
+    reader >> count;
+    reader >> target;
+    reader >> processor;
+    auto indices = reader.current_location();
+    reader.update(count * sizeof(size_t));
+
+    auto& buffer = get_response_buffers_[processor];
+    buffer << target;
+    buffer << (size_t)(size * count);
+    buffer.ensure_room(size * count);
+    auto packed = buffer.buffer();
+    auto location = (const char*)locations_[var_id];
+    for (size_t i = 0; i < count; ++i) {
+      size_t idx = 0;
+      memcpy(&idx, indices + i * sizeof(size_t), sizeof(size_t));
+      memcpy(packed + i * size, location + idx * size, size);
+    }
+    buffer.update(size * count);
+  }
+
+  void send_block_get_response_(memory_buffer::memory_reader& reader,
+                                int var_id) {
+    size_t size = 0;
+    void* target = nullptr;
+    int processor = 0;
+    auto src = detail::block_layout{};
+    reader >> size;
+    reader >> target;
+    reader >> processor;
+    reader >> src;
+
+    auto& buffer = get_response_buffers_[processor];
+    auto count = src.count();
+    buffer << target;
+    buffer << (size_t)(size * count);
+    buffer.ensure_room(size * count);
+    detail::copy_block((const char*)locations_[var_id], src, buffer.buffer(),
+                       detail::block_layout::packed(src), size);
+    buffer.update(size * count);
+  }
+
   void process_get_responses_(memory_buffer& buf) {
     auto reader = buf.reader();
     while (!reader.empty()) {
@@ -59,13 +59,17 @@ struct registered_queue {
 template <Barrier B>
 class world_state {
  public:
-  explicit world_state(int processors) : sync_barrier(processors) {
+  explicit world_state(int processors)
+      : sync_barrier(processors), collective_slots(processors) {
     variables_.reserve(20 * processors);
     queues_.reserve(20 * processors);
   }
 
   B sync_barrier;
 
+  // Each thread publishes the address of its data for a collective here
+  std::vector<void*> collective_slots;
+
   std::mutex var_mutex;
   std::vector<registered_variable> variables_;
 
@@ -84,7 +88,7 @@ class world : public bulk::world {
   world(std::shared_ptr<world_state<B>> state, int pid, int nprocs)
       : state_(state), pid_(pid), nprocs_(nprocs) {}
 
-  ~world() {}
+  ~world() { release_workspace_(); }
 
   // Needs a move for environment::spawn to work
   world(world&& other) {
@@ -95,6 +99,12 @@ class world : public bulk::world {
     var_put_tasks_ = std::move(other.var_put_tasks_);
     coarray_get_tasks_ = std::move(other.coarray_get_tasks_);
     coarray_put_tasks_ = std::move(other.coarray_put_tasks_);
+    coarray_gather_tasks_ = std::move(other.coarray_gather_tasks_);
+    coarray_scatter_tasks_ = std::move(other.coarray_scatter_tasks_);
+    coarray_block_get_tasks_ = std::move(other.coarray_block_get_tasks_);
+    coarray_block_put_tasks_ = std::move(other.coarray_block_put_tasks_);
+    task_indices_ = std::move(other.task_indices_);
+    serialize_buffer_ = std::move(other.serialize_buffer_);
   }
 
   int active_processors() const override { return nprocs_; }
@@ -103,6 +113,14 @@ class world : public bulk::world {
   void barrier() override { state_->sync_barrier.arrive_and_wait(); }
 
   void sync(bool clear_queues = true) override {
+    // Queues that hold back messages send them now
+    auto& qs = state_->queues_;
+    for (auto i = 0u; i < qs.size(); i += nprocs_) {
+      if (qs[i + pid_].base) {
+        qs[i + pid_].base->flush_();
+      }
+    }
+
     barrier();
 
     // core A: x = 5;
@@ -119,17 +137,28 @@ class world : public bulk::world {
     }
     coarray_get_tasks_.clear();
 
-    size_t max_size = 0;
-    for (auto& t : var_get_tasks_) {
-      max_size = std::max(max_size, t.var->serialized_size());
+    for (auto& t : coarray_gather_tasks_) {
+      for (size_t i = 0; i < t.count; ++i) {
+        memcpy(t.dst + i * t.size, t.src + index_(t, i) * t.size, t.size);
+      }
     }
-    char* buffer = new char[max_size];
+    coarray_gather_tasks_.clear();
+
+    for (auto& t : coarray_block_get_tasks_) {
+      detail::copy_block(t.src, t.from, t.dst, t.to, t.size);
+    }
+    coarray_block_get_tasks_.clear();
+
+    // The serialization buffer only grows, so that it is reused between
+    // supersteps
     for (auto& t : var_get_tasks_) {
       auto size = t.var->serialized_size();
-      t.var->serialize(buffer);
-      t.future->deserialize_get(size, buffer);
+      if (size > serialize_buffer_.size()) {
+        serialize_buffer_.resize(std::max(size, 2 * serialize_buffer_.size()));
+      }
+      t.var->serialize(serialize_buffer_.data());
+      t.future->deserialize_get(size, serialize_buffer_.data());
     }
-    delete[] buffer;
     var_get_tasks_.clear();
 
     barrier();
@@ -140,6 +169,20 @@ class world : public bulk::world {
     }
     coarray_put_tasks_.clear();
 
+    for (auto& t : coarray_scatter_tasks_) {
+      for (size_t i = 0; i < t.count; ++i) {
+        auto idx = index_(t, i);
+        memcpy(t.dst + idx * t.size, t.src + idx * t.size, t.size);
+      }
+    }
+    coarray_scatter_tasks_.clear();
+    task_indices_.clear();
+
+    for (auto& t : coarray_block_put_tasks_) {
+      detail::copy_block(t.src, t.from, t.dst, t.to, t.size);
+    }
+    coarray_block_put_tasks_.clear();
+
     for (auto& t : var_put_tasks_) {
       // we have written something to receiveBuffer earlier
       // now copy it to the var itself
@@ -148,7 +191,6 @@ class world : public bulk::world {
     var_put_tasks_.clear();
 
     // Queue messages to this processor
-    auto& qs = state_->queues_;
     for (auto i = 0u; i < qs.size(); i += nprocs_) {
       auto& rq = qs[i + pid_];
       if (rq.base) {  // If this is a registered queue
@@ -321,6 +363,63 @@ class world : public bulk::world {
     return;
   }
 
+  // Strided, indexed and block puts are staged in the receive buffer like
+  // `put_`, and then copied by a single task
+  void put_strided_(int processor, const void* values, std::size_t size,
+                    std::size_t src_stride, int var_id, std::size_t offset,
+                    std::size_t stride, std::size_t count) override {
+    put_block_(processor, values, size,
+               detail::block_layout::strided(0, src_stride, count), var_id,
+               detail::block_layout::strided(offset, stride, count));
+  }
+
+  void put_block_(int processor, const void* values, std::size_t size,
+                  const detail::block_layout& src, int var_id,
+                  const detail::block_layout& dst) override {
+    auto& v = get_var_(var_id, processor);
+    if (size * dst.end() > v.capacity) {
+      log("BULK ERROR: array put out of bounds");
+      return;
+    }
+    detail::copy_block((const char*)values, src, v.receiveBuffer, dst, size);
+    coarray_block_put_tasks_.push_back(
+        {(char*)v.buffer, v.receiveBuffer, size, dst, dst});
+  }
+
+  void put_indexed_(int processor, const void* values, std::size_t size,
+                    int var_id, const std::size_t* indices,
+                    std::size_t count) override {
+    auto& v = get_var_(var_id, processor);
+    for (size_t i = 0; i < count; ++i) {
+      if (size * (indices[i] + 1) > v.capacity) {
+        log("BULK ERROR: array put out of bounds");
+        return;
+      }
+    }
+    for (size_t i = 0; i < count; ++i) {
+      memcpy(v.receiveBuffer + size * indices[i],
+             (const char*)values + size * i, size);
+    }
+    coarray_scatter_tasks_.push_back(
+        {(char*)v.buffer, v.receiveBuffer, size, count, task_indices_.size()});
+    task_indices_.insert(task_indices_.end(), indices, indices + count);
+  }
+
+  void get_indexed_(int processor, int var_id, std::size_t size, void* target,
+                    const std::size_t* indices, std::size_t count) override {
+    coarray_gather_tasks_.push_back(
+        {(char*)target, (const char*)get_location_(var_id, processor), size,
+         count, task_indices_.size()});
+    task_indices_.insert(task_indices_.end(), indices, indices + count);
+  }
+
+  void get_block_(int processor, int var_id, std::size_t size, void* target,
+                  const detail::block_layout& src) override {
+    coarray_block_get_tasks_.push_back(
+        {(char*)target, (const char*)get_location_(var_id, processor), size,
+         src, detail::block_layout::packed(src)});
+  }
+
   void get_buffer_(int processor, int var_id,
                    class future_base* future) override {
     var_get_tasks_.push_back({future, get_var_(var_id, processor).base});
@@ -375,6 +474,57 @@ class world : public bulk::world {
     return;
   }
 
+  // The native collectives publish the address of the local data, after which
+  // every thread reads directly from the data of the others
+
+  bool allreduce_(void* values, size_t count, scalar_type type,
+                  reduce_op op) override {
+    sync();
+    auto& slots = state_->collective_slots;
+    slots[pid_] = values;
+    barrier();
+
+    // Each thread combines its block of every image into the image of the
+    // first thread, in rank order
+    auto size = detail::size_of(type);
+    auto [first, last] = detail::block_range(count, nprocs_, pid_);
+    for (int t = 1; t < nprocs_; ++t) {
+      detail::combine((char*)slots[0] + first * size,
+                      (char*)slots[t] + first * size, last - first, type, op);
+    }
+    barrier();
+
+    if (pid_ != 0) {
+      memcpy(values, slots[0], count * size);
+    }
+    barrier();
+    return true;
+  }
+
+  bool broadcast_(void* values, size_t size, int root) override {
+    sync();
+    auto& slots = state_->collective_slots;
+    slots[pid_] = values;
+    barrier();
+    if (pid_ != root) {
+      memcpy(values, slots[root], size);
+    }
+    barrier();
+    return true;
+  }
+
+  bool allgather_(const void* value, void* result, size_t size) override {
+    sync();
+    auto& slots = state_->collective_slots;
+    slots[pid_] = const_cast<void*>(value);
+    barrier();
+    for (int t = 0; t < nprocs_; ++t) {
+      memcpy((char*)result + t * size, slots[t], size);
+    }
+    barrier();
+    return true;
+  }
+
   char* send_buffer_(int processor, int queue_id, size_t size) override {
     char* buffer = new char[size];
     // Lock mutex only to append the pointer to vector
@@ -399,6 +549,26 @@ class world : public bulk::world {
     void* src;
     size_t size;
   };
+  // Task for elements that are scattered over an image, at the indices
+  // `task_indices_[first + i]`
+  struct scatter_task {
+    char* dst;
+    const char* src;
+    size_t size;  // per element
+    size_t count;
+    size_t first;
+  };
+  size_t index_(const scatter_task& t, size_t i) const {
+    return task_indices_[t.first + i];
+  }
+  // Task for copying the block `from` of `src` to the block `to` of `dst`
+  struct block_task {
+    char* dst;
+    const char* src;
+    size_t size;  // per element
+    detail::block_layout from;
+    detail::block_layout to;
+  };
   // Task for data that needs serialization
   struct get_task {
     class future_base* future;  // dst
@@ -409,6 +579,14 @@ class world : public bulk::world {
   std::vector<registered_variable*> var_put_tasks_;
   std::vector<copy_task> coarray_get_tasks_;
   std::vector<copy_task> coarray_put_tasks_;
+  // Gathers copy element `i` from the scattered source indices to index `i`
+  // of `dst`, and scatters copy each element to the same index of `dst`
+  std::vector<scatter_task> coarray_gather_tasks_;
+  std::vector<scatter_task> coarray_scatter_tasks_;
+  std::vector<size_t> task_indices_;
+  std::vector<block_task> coarray_block_get_tasks_;
+  std::vector<block_task> coarray_block_put_tasks_;
+  std::vector<char> serialize_buffer_;
 };
 
 }  // namespace bulk::thread
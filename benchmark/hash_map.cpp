@@ -0,0 +1,107 @@
+#include <bulk/bulk.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../examples/set_backend.hpp"
+
+int main(int argc, char** argv) {
+  environment env;
+
+  // The number of operations per processor, and the number of distinct keys
+  size_t n = argc > 1 ? std::atol(argv[1]) : 1 << 22;
+  size_t k = argc > 2 ? std::atol(argv[2]) : 1 << 16;
+
+  env.spawn(env.available_processors(), [&](bulk::world& world) {
+    auto s = world.rank();
+    auto p = world.active_processors();
+    auto gen = std::mt19937_64(s);
+    auto keys = std::vector<std::uint64_t>(n);
+    for (auto& key : keys) {
+      key = gen() % k;
+    }
+
+    // Millions of operations per second per processor
+    auto rate = [&](double ms) { return n / (1000.0 * ms); };
+    auto report = bulk::util::table("Distributed hash map", "operation");
+    report.columns("Mops/s per processor");
+
+    // (1) Counting with an ordered map and a queue, as the word count used to
+    {
+      world.sync();
+      auto clock = bulk::util::timer();
+      auto q = bulk::queue<std::uint64_t, int>(world);
+      for (auto key : keys) {
+        q(std::hash<std::uint64_t>{}(key) % p).send(key, 1);
+      }
+      world.sync();
+      auto counts = std::map<std::uint64_t, int>{};
+      for (auto [key, count] : q) {
+        counts[key] += count;
+      }
+      auto ms = bulk::max(world, clock.get());
+      report.row("std::map and queue", rate(ms));
+    }
+
+    auto map = bulk::distributed_unordered_map<std::uint64_t, int>(world);
+    auto measure = [&](const char* name, auto f) {
+      world.sync();
+      auto clock = bulk::util::timer();
+      f();
+      auto ms = bulk::max(world, clock.get());
+      report.row(name, rate(ms));
+    };
+
+    // (2) Counting, inserting and setting values
+    measure("combine", [&] {
+      for (auto key : keys) {
+        map.combine(key, 1);
+      }
+      world.sync();
+    });
+    measure("insert", [&] {
+      for (auto key : keys) {
+        map.insert(key + k, 1);
+      }
+      world.sync();
+    });
+    measure("upsert", [&] {
+      for (auto key : keys) {
+        map.upsert(key, s);
+      }
+      world.sync();
+    });
+
+    // (3) Looking up values, in a batch and with a future per lookup
+    auto results = std::vector<std::optional<int>>(n);
+    measure("find (batch)", [&] {
+      map.find(keys, results);
+      map.sync();
+    });
+    auto m = std::min<size_t>(n, 1 << 12);
+    auto futures = std::vector<bulk::future<std::optional<int>>>{};
+    futures.reserve(m);
+    world.sync();
+    auto clock = bulk::util::timer();
+    for (size_t i = 0; i < m; ++i) {
+      futures.push_back(map.find(keys[i]));
+    }
+    map.sync();
+    auto ms = bulk::max(world, clock.get());
+    report.row("find (future)", m / (1000.0 * ms));
+
+    if (s == 0) {
+      world.log("%zu operations per processor on %zu keys, %d processors", n,
+                k, p);
+      world.log(report.print().c_str());
+      world.log("lookups with futures: %zu per processor", m);
+    }
+  });
+
+  return 0;
+}
@@ -0,0 +1,186 @@
+#include <bulk/bulk.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../examples/set_backend.hpp"
+
+// Factor `p` into a grid of three near-equal factors
+bulk::index_type<3> processor_grid(size_t p) {
+  auto grid = bulk::index_type<3>{1, 1, 1};
+  for (size_t f = 2; p > 1;) {
+    if (p % f != 0) {
+      ++f;
+      continue;
+    }
+    // Assign the factor to the smallest axis so far
+    auto d = 0;
+    for (int e = 1; e < 3; ++e) {
+      if (grid[e] < grid[d]) {
+        d = e;
+      }
+    }
+    grid[d] *= f;
+    p /= f;
+  }
+  return grid;
+}
+
+int main(int argc, char** argv) {
+  environment env;
+
+  // The number of cells per processor along each axis
+  size_t n = argc > 1 ? std::atoi(argv[1]) : 64;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+
+  env.spawn(env.available_processors(), [=](bulk::world& world) {
+    int s = world.rank();
+    size_t p = world.active_processors();
+
+    auto grid = processor_grid(p);
+    auto size = bulk::index_type<3>{n * grid[0], n * grid[1], n * grid[2]};
+    auto part = bulk::block_partitioning<3>(size, grid);
+    auto me = part.multi_rank(s);
+    auto local = part.local_size(s);
+    auto halo = bulk::halo_exchange<double, 3>(world, part, 1, false);
+    auto shape = halo.shape();
+
+    // The ghost cells on the global boundary hold the boundary value 1, the
+    // other cells start at 0
+    auto u = halo.field(1.0);
+    auto v = halo.field(1.0);
+    auto reset = [&]() {
+      for (size_t k = 1; k <= local[2]; ++k) {
+        for (size_t j = 1; j <= local[1]; ++j) {
+          for (size_t i = 1; i <= local[0]; ++i) {
+            u[halo.index({i, j, k})] = 0.0;
+            v[halo.index({i, j, k})] = 0.0;
+          }
+        }
+      }
+      world.sync();
+    };
+
+    auto dy = shape[0];
+    auto dz = shape[0] * shape[1];
+    // Relax the cells [lo, hi) along the first axis of row (j, k)
+    auto relax = [&](auto& from, auto& to, size_t j, size_t k, size_t lo,
+                     size_t hi) {
+      auto x = from.data();
+      auto y = to.data();
+      for (auto a = halo.index({lo, j, k}); a < halo.index({hi, j, k}); ++a) {
+        y[a] = (x[a - 1] + x[a + 1] + x[a - dy] + x[a + dy] + x[a - dz] +
+                x[a + dz]) /
+               6.0;
+      }
+    };
+    // Relax the cells in [lo, hi) along each axis, except those in
+    // [inner_lo, inner_hi) along each axis
+    auto sweep = [&](auto& from, auto& to, size_t lo, size_t hi,
+                     size_t inner_lo, size_t inner_hi) {
+      auto inner = [&](size_t x) { return x >= inner_lo && x < inner_hi; };
+      for (size_t k = lo; k < hi; ++k) {
+        for (size_t j = lo; j < hi; ++j) {
+          if (inner(j) && inner(k)) {
+            relax(from, to, j, k, lo, inner_lo);
+            relax(from, to, j, k, inner_hi, hi);
+          } else {
+            relax(from, to, j, k, lo, hi);
+          }
+        }
+      }
+    };
+
+    // (1) A hand-written exchange of the faces, with a put per cell
+    auto naive_exchange = [&](auto& field) {
+      for (int d = 0; d < 3; ++d) {
+        for (int side = 0; side < 2; ++side) {
+          auto target = me;
+          if (side == 0 ? me[d] == 0 : me[d] + 1 == grid[d]) {
+            continue;
+          }
+          target[d] = side == 0 ? me[d] - 1 : me[d] + 1;
+          auto t = part.rank(target);
+          auto target_size = part.local_size(target);
+          auto target_shape = bulk::index_type<3>{
+              target_size[0] + 2, target_size[1] + 2, target_size[2] + 2};
+
+          auto extent = local;
+          extent[d] = 1;
+          for (size_t k = 0; k < extent[2]; ++k) {
+            for (size_t j = 0; j < extent[1]; ++j) {
+              for (size_t i = 0; i < extent[0]; ++i) {
+                auto src = bulk::index_type<3>{i + 1, j + 1, k + 1};
+                auto dst = src;
+                if (side == 0) {
+                  dst[d] = target_size[d] + 1;
+                } else {
+                  src[d] = local[d];
+                  dst[d] = 0;
+                }
+                field.put(t, bulk::util::flatten<3>(target_shape, dst),
+                          field[halo.index(src)]);
+              }
+            }
+          }
+        }
+      }
+      world.sync();
+    };
+
+    auto run = [&](auto step) {
+      reset();
+      auto clock = bulk::util::timer();
+      for (int it = 0; it < iterations; ++it) {
+        if (it % 2 == 0) {
+          step(u, v);
+        } else {
+          step(v, u);
+        }
+      }
+      auto ms = bulk::max(world, clock.get());
+      // The sum of the cells, which should not depend on the exchange
+      auto& result = iterations % 2 == 0 ? u : v;
+      auto total = 0.0;
+      for (size_t k = 1; k <= local[2]; ++k) {
+        for (size_t j = 1; j <= local[1]; ++j) {
+          for (size_t i = 1; i <= local[0]; ++i) {
+            total += result[halo.index({i, j, k})];
+          }
+        }
+      }
+      total = bulk::sum(world, total);
+      return std::make_pair(ms / iterations, total);
+    };
+
+    auto naive = run([&](auto& from, auto& to) {
+      naive_exchange(from);
+      sweep(from, to, 1, n + 1, 0, 0);
+    });
+    // (2) The halo exchange, followed by the sweep
+    auto exchange = run([&](auto& from, auto& to) {
+      halo.exchange(from);
+      sweep(from, to, 1, n + 1, 0, 0);
+    });
+    // (3) The halo exchange, overlapped with the sweep over the interior
+    auto overlap = run([&](auto& from, auto& to) {
+      halo.start(from);
+      sweep(from, to, 2, n, 0, 0);
+      world.sync();
+      sweep(from, to, 1, n + 1, 2, n);
+    });
+
+    if (s == 0) {
+      auto report = bulk::util::table("3D Jacobi", "exchange");
+      report.columns("ms / iteration", "sum");
+      report.row("element-wise puts", naive.first, naive.second);
+      report.row("halo exchange", exchange.first, exchange.second);
+      report.row("overlapped", overlap.first, overlap.second);
+      world.log("grid: %zu x %zu x %zu, cells: %zu x %zu x %zu", grid[0],
+                grid[1], grid[2], size[0], size[1], size[2]);
+      world.log(report.print().c_str());
+    }
+  });
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include <bulk/bulk.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../examples/set_backend.hpp"
+
+int main(int argc, char** argv) {
+  environment env;
+
+  // The corpus is counted `copies` times in all, so that there is enough work
+  size_t copies = argc > 1 ? std::atol(argv[1]) : 256;
+  auto path = std::string(argc > 2 ? argv[2] : "examples/data/alice.txt");
+
+  auto f = std::fstream(path);
+  auto words = std::vector<std::string>(std::istream_iterator<std::string>(f),
+                                        std::istream_iterator<std::string>());
+  if (words.empty()) {
+    std::printf("Could not read %s, run from the project root\n", path.c_str());
+    return 1;
+  }
+
+  env.spawn(env.available_processors(), [&](bulk::world& world) {
+    auto s = world.rank();
+    auto p = world.active_processors();
+    auto by_count = [](const auto& lhs, const auto& rhs) {
+      return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
+    };
+
+    // Each processor counts a block of the copies of the corpus
+    auto local = std::vector<std::string>{};
+    for (auto c = copies * s / p; c < copies * (s + 1) / p; ++c) {
+      local.insert(local.end(), words.begin(), words.end());
+    }
+    auto n = bulk::sum(world, local.size());
+
+    auto report = bulk::util::table("Word count", "pipeline");
+    report.columns("time (ms)", "Mwords/s", "distinct words");
+    auto measure = [&](const char* name, auto f) {
+      world.sync();
+      auto clock = bulk::util::timer();
+      auto distinct = f();
+      auto ms = bulk::max(world, clock.get());
+      if (s == 0) {
+        report.row(name, ms, n / (1000.0 * ms), distinct);
+      }
+    };
+
+    // (1) A message per word, reduced into an ordered map, and sorted on the
+    // first processor
+    measure("queue and std::map", [&] {
+      auto q = bulk::queue<std::string, int>(world);
+      for (auto& word : local) {
+        q(std::hash<std::string>{}(word) % p).send(word, 1);
+      }
+      world.sync();
+      auto counts = std::map<std::string, int>{};
+      for (auto& [word, count] : q) {
+        counts[word] += count;
+      }
+      auto gather = bulk::queue<std::string, int>(world);
+      for (auto& [word, count] : counts) {
+        gather(0).send(word, count);
+      }
+      world.sync();
+      auto all = std::vector<std::pair<std::string, int>>{};
+      for (auto& [word, count] : gather) {
+        all.emplace_back(word, count);
+      }
+      std::sort(all.begin(), all.end(), by_count);
+      return all.size();
+    });
+
+    // (2) Local combiners, a parallel reduce, and a gather along a tree
+    measure("bulk::map_reduce", [&] {
+      auto counts = bulk::map_reduce<std::string, int>(
+          world, local,
+          [](const std::string& word, auto& emit) { emit(word, 1); });
+      auto all = bulk::gather_sorted(world, std::move(counts), by_count);
+      return all.size();
+    });
+
+    if (s == 0) {
+      world.log("%zu words in all (%zu copies of %s), %d processors", n,
+                copies, path.c_str(), p);
+      world.log(report.print().c_str());
+    }
+  });
+
+  return 0;
+}
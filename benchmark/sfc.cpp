@@ -0,0 +1,98 @@
+#include <bulk/bulk.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using index3 = bulk::index_type<3>;
+
+// The most cube-like grid of `p` processors
+index3 cube_grid(size_t p) {
+  auto best = index3{p, 1, 1};
+  for (size_t a = 1; a <= p; ++a) {
+    for (size_t b = 1; a * b <= p; ++b) {
+      if (p % (a * b) != 0) {
+        continue;
+      }
+      auto c = p / (a * b);
+      auto spread = std::max({a, b, c}) - std::min({a, b, c});
+      if (spread < std::max({best[0], best[1], best[2]}) -
+                       std::min({best[0], best[1], best[2]})) {
+        best = {a, b, c};
+      }
+    }
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? std::atol(argv[1]) : 100;
+  size_t p = argc > 2 ? std::atol(argv[2]) : 64;
+  auto size = index3{n, n, n};
+  auto volume = n * n * n;
+
+  auto slabs = bulk::block_partitioning<3, 1>(size, {p}, {2});
+  auto blocks = bulk::block_partitioning<3>(size, cube_grid(p));
+  auto morton = bulk::sfc_partitioning<3>(size, p, bulk::sfc_curve::morton);
+  auto hilbert = bulk::sfc_partitioning<3>(size, p, bulk::sfc_curve::hilbert);
+
+  auto gen = std::mt19937_64(1);
+  auto xs = std::vector<index3>(1 << 22);
+  for (auto& x : xs) {
+    x = {gen() % n, gen() % n, gen() % n};
+  }
+
+  auto report = bulk::util::table("Partitionings of a cube", "partitioning");
+  report.columns("max faces", "total faces", "ns / owner");
+  auto measure = [&](auto name, bulk::partitioning<3>& part) {
+    // The faces between elements of different processors, i.e. the ghost
+    // cells of a 7-point stencil
+    auto owners = std::vector<int>(volume);
+    for (size_t i = 0; i < volume; ++i) {
+      owners[i] = part.owner(bulk::util::unflatten<3>(size, i));
+    }
+    auto faces = std::vector<size_t>(p);
+    size_t stride = 1;
+    for (int d = 0; d < 3; ++d) {
+      for (size_t i = 0; i < volume; ++i) {
+        auto x = (i / stride) % n;
+        if (x + 1 < n && owners[i] != owners[i + stride]) {
+          ++faces[owners[i]];
+          ++faces[owners[i + stride]];
+        }
+      }
+      stride *= n;
+    }
+    size_t total = 0;
+    size_t most = 0;
+    for (auto f : faces) {
+      total += f;
+      most = std::max(most, f);
+    }
+
+    auto clock = bulk::util::timer();
+    long long sum = 0;
+    for (auto& x : xs) {
+      sum += part.owner(x);
+    }
+    auto ns = 1e6 * clock.get() / xs.size();
+    report.row(name, most, total, ns);
+    return sum;
+  };
+
+  measure("1D blocks", slabs);
+  measure("3D blocks", blocks);
+  measure("Morton", morton);
+  measure("Hilbert", hilbert);
+
+  auto owners = std::vector<int>(xs.size());
+  auto clock = bulk::util::timer();
+  hilbert.owner_batch(xs, owners);
+  auto batched = 1e6 * clock.get() / xs.size();
+
+  printf("%zu^3 elements over %zu processors\n", n, p);
+  printf("%s", report.print().c_str());
+  printf("Hilbert, owner_batch: %.2f ns / owner\n", batched);
+
+  return 0;
+}
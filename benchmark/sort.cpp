@@ -0,0 +1,82 @@
+#include <bulk/bulk.hpp>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../examples/set_backend.hpp"
+
+int main(int argc, char** argv) {
+  environment env;
+
+  // The total number of values for strong scaling, and the number of values
+  // per processor for weak scaling
+  size_t n = argc > 1 ? std::atol(argv[1]) : 1 << 22;
+  size_t m = argc > 2 ? std::atol(argv[2]) : 1 << 20;
+
+  // The MPI backend always runs on all processors, so that scaling is measured
+  // over several runs
+  auto counts = std::vector<int>{};
+#if defined BACKEND_MPI
+  counts.push_back(env.available_processors());
+#else
+  for (int q = 1; q < env.available_processors(); q *= 2) {
+    counts.push_back(q);
+  }
+  counts.push_back(env.available_processors());
+#endif
+
+  auto report = bulk::util::table("Sample sort", "processors");
+  report.columns("strong (int)", "strong (double)", "weak (int)",
+                 "duplicates", "imbalance");
+  for (auto q : counts) {
+    env.spawn(q, [&](bulk::world& world) {
+      auto s = world.rank();
+      auto p = world.active_processors();
+      auto gen = std::mt19937_64(s);
+
+      auto measure = [&](auto& xs, auto... args) {
+        world.sync();
+        auto clock = bulk::util::timer();
+        auto ys = bulk::sort(world, std::span(xs), args...);
+        auto ms = bulk::max(world, clock.get());
+        // The largest part relative to the average
+        auto imbalance = bulk::max(world, ys.size()) * p /
+                         (double)bulk::sum(world, ys.size());
+        return std::make_pair(ms, imbalance);
+      };
+
+      auto strong = std::vector<int>(n / p);
+      for (auto& x : strong) {
+        x = static_cast<int>(gen());
+      }
+      auto strong_doubles = std::vector<double>(strong.begin(), strong.end());
+      auto weak = std::vector<int>(m);
+      for (auto& x : weak) {
+        x = static_cast<int>(gen());
+      }
+      // Most values are equal to one of a few keys
+      auto duplicates = std::vector<int>(n / p);
+      for (auto& x : duplicates) {
+        x = static_cast<int>(gen() % 4);
+      }
+
+      auto a = measure(strong);
+      auto b = measure(strong_doubles);
+      auto c = measure(weak);
+      auto d = measure(duplicates);
+      if (s == 0) {
+        report.row(std::to_string(p), a.first, b.first, c.first, d.first,
+                   d.second);
+      }
+      if (s == 0 && q == counts.back()) {
+        world.log("strong: %zu values in all, weak: %zu values per processor",
+                  n, m);
+        world.log(report.print().c_str());
+        world.log("times in ms, imbalance: largest part over average part");
+      }
+    });
+  }
+
+  return 0;
+}
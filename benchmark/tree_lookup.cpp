@@ -0,0 +1,97 @@
+#include <bulk/bulk.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using tree_type = bulk::util::binary_tree<bulk::util::split>;
+
+// Split the volume [lower, upper) into 2^depth blocks, alternating the axes
+void build(tree_type& tree, tree_type::node* parent, tree_type::dir direction,
+           bulk::index_type<2> lower, bulk::index_type<2> upper, int depth,
+           int k) {
+  if (k == depth) {
+    return;
+  }
+  auto d = k % 2;
+  auto a = (lower[d] + upper[d]) / 2 - 1;
+  auto node = tree.add(parent, direction, bulk::util::split{d, a});
+  auto left_upper = upper;
+  left_upper[d] = a + 1;
+  auto right_lower = lower;
+  right_lower[d] = a + 1;
+  build(tree, node, tree_type::dir::left, lower, left_upper, depth, k + 1);
+  build(tree, node, tree_type::dir::right, right_lower, upper, depth, k + 1);
+}
+
+// The lookup by following the pointers of the tree of splits
+int pointer_owner(const tree_type& tree, bulk::index_type<2> xs) {
+  auto node = tree.root.get();
+  int proc = 0;
+  int depth = 0;
+  while (node) {
+    if (xs[node->value.d] <= node->value.a) {
+      node = node->left.get();
+    } else {
+      proc += 1 << depth;
+      node = node->right.get();
+    }
+    ++depth;
+  }
+  return proc;
+}
+
+int main(int argc, char** argv) {
+  int depth = argc > 1 ? std::atoi(argv[1]) : 16;
+  size_t count = argc > 2 ? std::atol(argv[2]) : 1 << 23;
+
+  auto size = bulk::index_type<2>{1 << 20, 1 << 20};
+  auto tree = tree_type{};
+  build(tree, nullptr, tree_type::dir::left, {0, 0}, size, depth, 0);
+  auto flat = bulk::util::split_tree<2>(size, tree);
+
+  auto gen = std::mt19937_64(1);
+  auto xs = std::vector<bulk::index_type<2>>(count);
+  for (auto& x : xs) {
+    x = {gen() % size[0], gen() % size[1]};
+  }
+  auto owners = std::vector<int>(count);
+
+  auto run = [&](auto lookup) {
+    auto clock = bulk::util::timer();
+    lookup();
+    auto ms = clock.get();
+    // a checksum, so that the lookups are not optimized away
+    long long sum = 0;
+    for (auto owner : owners) {
+      sum += owner;
+    }
+    return std::make_pair(ms, sum);
+  };
+
+  auto pointer = run([&]() {
+    for (size_t i = 0; i < count; ++i) {
+      owners[i] = pointer_owner(tree, xs[i]);
+    }
+  });
+  auto single = run([&]() {
+    for (size_t i = 0; i < count; ++i) {
+      owners[i] = flat.find(xs[i]);
+    }
+  });
+  auto batch = run([&]() { flat.find_batch(xs, owners); });
+
+  auto report = bulk::util::table("Tree lookup", "method");
+  report.columns("ms", "ns / lookup", "checksum");
+  auto row = [&](auto name, auto result) {
+    report.row(name, result.first, 1e6 * result.first / count,
+               std::to_string(result.second));
+  };
+  row("pointer tree", pointer);
+  row("split tree", single);
+  row("split tree, batched", batch);
+  printf("%zu lookups in a tree with %d leaves\n", count, 1 << depth);
+  printf("%s", report.print().c_str());
+
+  return 0;
+}
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <iomanip>
 #include <numeric>
+#include <span>
 
 #include "bulk/bulk.hpp"
 #include "vector.hpp"
@@ -16,13 +17,18 @@ class matrix {
          T value = 0)
       : world_(world),
         partitioning_(partitioning),
-        data_(world_, partitioning.local_count(world_.rank()), value) {}
+        data_(world_, partitioning, value),
+        view_(data_.view()) {}
 
-  T& at(bulk::index_type<2> index) {
-    return data_[bulk::util::flatten<2>(
-        partitioning_.local_size(partitioning_.multi_rank(world_.rank())),
-        index)];
-  }
+  T& at(bulk::index_type<2> index) { return view_[index]; }
+
+  /** A view of the local elements, column by column, i.e. with the row
+   * index contiguous. */
+  bulk::local_view<T, 2> view() { return view_; }
+
+  /** The local number of rows, i.e. the stride between the elements of a
+   * local row. */
+  auto local_rows() { return data_.local_size()[0]; }
 
   auto& partitioning() { return partitioning_; };
   auto& world() { return world_; };
@@ -33,7 +39,8 @@ class matrix {
  private:
   bulk::world& world_;
   bulk::cartesian_partitioning<2, 2>& partitioning_;
-  bulk::coarray<T> data_;
+  bulk::partitioned_array<T, 2> data_;
+  bulk::local_view<T, 2> view_;
 };
 
 template <typename T>
@@ -124,18 +131,17 @@ bulk::coarray<size_t> lu(matrix<T>& mat) {
     // (5) Update local permutation vector
     // ... not necessary
 
-    // (6) Communicate row k and r
+    // (6) Communicate row k and r, which are strided in the local matrix
+    auto rows = mat.local_rows();
     if (static_cast<size_t>(psi.owner(0, k)) == s) {
-      for (auto j = 0ul; j < psi.local_size(1, t); ++j) {
-        row_swap_k(psi.rank({static_cast<size_t>(psi.owner(0, r)), t}))[j] =
-            mat.at({psi.local(0, k), j});
-      }
+      row_swap_k.put_strided(
+          psi.rank({static_cast<size_t>(psi.owner(0, r)), t}),
+          &mat.at({psi.local(0, k), 0}), rows, 0, 1, psi.local_size(1, t));
     }
     if (static_cast<size_t>(psi.owner(0, r)) == s) {
-      for (auto j = 0ul; j < psi.local_size(1, t); ++j) {
-        row_swap_r(psi.rank({static_cast<size_t>(psi.owner(0, k)), t}))[j] =
-            mat.at({psi.local(0, r), j});
-      }
+      row_swap_r.put_strided(
+          psi.rank({static_cast<size_t>(psi.owner(0, k)), t}),
+          &mat.at({psi.local(0, r), 0}), rows, 0, 1, psi.local_size(1, t));
     }
 
     world.sync();
@@ -169,11 +175,10 @@ bulk::coarray<size_t> lu(matrix<T>& mat) {
 
     // (10) Horizontal, communicate column k
     if (static_cast<size_t>(psi.owner(1, k)) == t) {
+      auto column = std::span<T>(&mat.at({0, psi.local(1, k)}),
+                                 psi.local_size(0, s));
       for (auto v = 0ul; v < psi.grid()[1]; ++v) {
-        auto target_rank = psi.rank({s, v});
-        for (auto i = 0ul; i < psi.local_size(0, s); ++i) {
-          col_k(target_rank)[i] = mat.at({i, psi.local(1, k)});
-        }
+        col_k(psi.rank({s, v}))[{size_t{0}, column.size()}] = column;
       }
     }
     world.sync();
@@ -181,18 +186,20 @@ bulk::coarray<size_t> lu(matrix<T>& mat) {
     // (10b) Vertical, communicate row k
     if (static_cast<size_t>(psi.owner(0, k)) == s) {
       for (auto u = 0ul; u < psi.grid()[0]; ++u) {
-        auto target_rank = psi.rank({u, t});
-        for (auto j = 0ul; j < psi.local_size(1, t); ++j) {
-          row_k(target_rank)[j] = mat.at({psi.local(0, k), j});
-        }
+        row_k.put_strided(psi.rank({u, t}), &mat.at({psi.local(0, k), 0}),
+                          rows, 0, 1, psi.local_size(1, t));
       }
     }
     world.sync();
 
-    // (11) Update bottom right block
-    for (auto i = ls[k]; i < psi.local_size(0, s); ++i) {
-      for (auto j = qs[k]; j < psi.local_size(1, t); ++j) {
-        mat.at({i, j}) -= col_k[i] * row_k[j];
+    // (11) Update bottom right block, column by column since the elements of
+    // a column (the row index `i`) are contiguous, so `i` is the inner loop
+    auto a = mat.view();
+    auto col = col_k.data();
+    auto row = row_k.data();
+    for (auto j = qs[k]; j < a.extent(1); ++j) {
+      for (auto i = ls[k]; i < a.extent(0); ++i) {
+        a(i, j) -= col[i] * row[j];
       }
     }
 
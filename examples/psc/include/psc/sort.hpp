@@ -5,6 +5,7 @@
 #include <functional>
 #include <limits>
 #include <numeric>
+#include <span>
 #include <sstream>
 
 #include "vector.hpp"
@@ -85,10 +86,10 @@ bulk::coarray<T> sort(vector<T>& x) {
   std::partial_sum(block_sizes.begin(), block_sizes.end() - 1,
                    block_starts.begin() + 1);
 
-  auto q = bulk::queue<T[]>(world);
+  // The received blocks are views into storage owned by the queue
+  auto q = bulk::queue<std::span<const T>>(world);
   for (int t = 0; t < p; ++t) {
-    q(t).send(std::vector<T>(x.begin() + block_starts[t],
-                             x.begin() + block_starts[t] + block_sizes[t]));
+    q(t).send(std::span<const T>(x.begin() + block_starts[t], block_sizes[t]));
   }
   world.sync();
 
@@ -1,7 +1,9 @@
 #include <fstream>
-#include <functional>
-#include <map>
+#include <iterator>
+#include <span>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "bulk/bulk.hpp"
 #include "set_backend.hpp"
@@ -16,52 +18,31 @@ int main() {
     auto s = world.rank();
     auto p = world.active_processors();
 
-    // We create a queue that holds the individual words of the text
-    auto words = bulk::queue<std::string>(world);
-
-    // The first processor is the master; it reads the file and sends the
-    // individual words around
-    if (s == 0) {
-      // We run this example from the project root, and open the text
-      auto f = std::fstream("examples/data/alice.txt");
-
-      // We loop over all the words in the text
-      std::string word;
-      while (f >> word) {
-        // For each word, we compute a hash. This hash decides the
-        // receiving processor, who is responsible for counting the
-        // occurences of that word. This is called the _map_ step
-        words(std::hash<std::string>{}(word) % p).send(word);
-      }
-    }
-
-    world.sync();
-
-    // This next block groups the words together, and corresponds to the
-    // usual reduce phase.
-    auto counts = std::map<std::string, int>{};
-    for (auto word : words) {
-      if (counts.find(word) != counts.end()) {
-        counts[word]++;
-      } else {
-        counts[word] = 1;
-      }
-    }
-
-    // We send the results back to the master
-    auto report = bulk::queue<std::string, int>(world);
-    for (auto [word, count] : counts) {
-      report(0).send(word, count);
-    }
-
-    world.sync();
-
-    // The master sorts the incoming reports, and logs the resulting counts
-    std::sort(report.begin(), report.end(), [](auto lhs, auto rhs) {
-      return std::get<1>(lhs) < std::get<1>(rhs);
-    });
-
-    for (auto [word, count] : report) {
+    // We run this example from the project root, and open the text. Each
+    // processor reads the words, and counts its own block of them
+    auto f = std::fstream("examples/data/alice.txt");
+    auto words = std::vector<std::string>(std::istream_iterator<std::string>(f),
+                                          std::istream_iterator<std::string>());
+    auto first = words.size() * s / p;
+    auto last = words.size() * (s + 1) / p;
+    auto block = std::span(words).subspan(first, last - first);
+
+    // The _map_ step emits a count for each word. The counts of the same word
+    // are added locally, and then by the processor that is responsible for
+    // the word, which is decided by its hash. This is the _reduce_ step
+    auto counts = bulk::map_reduce<std::string, int>(
+        world, block,
+        [](const std::string& word, auto& emit) { emit(word, 1); });
+
+    // The counts are merged along a tree on the first processor, in order of
+    // their count, and logged
+    auto sorted = bulk::gather_sorted(
+        world, std::move(counts), [](const auto& lhs, const auto& rhs) {
+          return std::tie(lhs.second, lhs.first) <
+                 std::tie(rhs.second, rhs.first);
+        });
+
+    for (auto& [word, count] : sorted) {
       world.log("%s: %d", word.c_str(), count);
     }
   });
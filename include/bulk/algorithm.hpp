@@ -12,41 +12,355 @@
 #include <limits>
 #include <numeric>
 #include <ranges>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include "coarray.hpp"
 #include "communication.hpp"
+#include "util/reduce.hpp"
+#include "util/workspace.hpp"
 #include "world.hpp"
 
 namespace bulk {
 
+namespace detail {
+
+// Broadcasts of at most this many bytes are forwarded along a binomial tree,
+// larger broadcasts are scattered and then all-gathered.
+constexpr std::size_t broadcast_tree_threshold = 4096;
+
+// The half-open range `[first, last)` of the `t`-th of `p` (nearly) equal
+// blocks of `[0, n)`.
+inline std::pair<std::size_t, std::size_t> block_range(std::size_t n, int p,
+                                                       int t) {
+  auto k = (n + p - 1) / p;
+  auto first = std::min(n, t * k);
+  return {first, std::min(n, first + k)};
+}
+
+// Access to the native collectives of the backend, see `world.hpp`. Each of
+// these returns false if the backend does not implement the collective.
+struct collectives {
+  static bool allreduce(bulk::world& world, void* values, std::size_t count,
+                        scalar_type type, reduce_op op) {
+    return world.allreduce_(values, count, type, op);
+  }
+
+  static bool broadcast(bulk::world& world, void* values, std::size_t size,
+                        int root) {
+    return world.broadcast_(values, size, root);
+  }
+
+  static bool allgather(bulk::world& world, const void* value, void* result,
+                        std::size_t size) {
+    return world.allgather_(value, result, size);
+  }
+};
+
+// Reduce the `n` values at `xs` element-wise over all processors in place,
+// using the native collective of the backend if `T` and `Func` allow it.
+template <typename T, typename Func>
+bool native_allreduce_(bulk::world& world, T* xs, std::size_t n) {
+  constexpr auto type = scalar_type_of<T>();
+  constexpr auto op = reduce_op_of<T, Func>();
+  if constexpr (type && op) {
+    return collectives::allreduce(world, xs, n, *type, *op);
+  } else {
+    return false;
+  }
+}
+
+// The all-gather of `gather_all` for backends without a native one, in which
+// each processor writes its value to the workspace of every other processor
+template <typename T>
+std::vector<T> gather_all_(bulk::world& world, T value) {
+  auto p = world.active_processors();
+  auto s = world.rank();
+
+  detail::workspace& ws = detail::workspace::of(world, p * sizeof(T));
+  auto xs = ws.data<T>();
+  for (int t = 0; t < p; ++t) {
+    if (t != s) {
+      ws.put(t, &value, s, 1);
+    }
+  }
+  xs[s] = value;
+  world.sync();
+
+  return std::vector<T>(xs, xs + p);
+}
+
+}  // namespace detail
+
 /**
- * Create a coarray with images holding the given value on each processor.
+ * Gather the given value of each processor on every processor.
  *
  * This function takes an argument, and writes it to the appropriate element on
- * each remote processor.
+ * each remote processor. The values are written to the scratch space of the
+ * world, so that no coarray is registered.
  *
  * The cost is `p * g + l`.
  *
- * \tparam T the type of the value to put in the coarray
+ * \tparam T the type of the value to gather
  *
  * \param value the value to write to each remote processor
  * \param world the world in which the communication takes place
  *
- * \returns a coarray containing on each processor the argument given by each
- * other processor.
+ * \returns a vector containing at index `t` the argument given by processor
+ * `t`.
  */
 template <typename T>
-bulk::coarray<T> gather_all(bulk::world& world, T value) {
-  bulk::coarray<T> xs(world, world.active_processors());
+std::vector<T> gather_all(bulk::world& world, T value) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "gather_all only supports trivially-copyable types");
+  auto p = world.active_processors();
+
+  detail::workspace& ws = detail::workspace::of(world, p * sizeof(T));
+  auto xs = ws.data<T>();
+  if (detail::collectives::allgather(world, &value, xs, sizeof(T))) {
+    return std::vector<T>(xs, xs + p);
+  }
+  return detail::gather_all_(world, value);
+}
 
-  for (int t = 0; t < world.active_processors(); ++t) {
-    xs(t)[world.rank()] = value;
+namespace detail {
+
+// Element-wise reduction of the `n` values at `xs` over all processors, in
+// rank order and starting from `*start` if it is given. Processor `s` obtains
+// the reduced values of block `s` of `[0, n)`, see `block_range`.
+//
+// Every processor sends (and receives) each of its values once. The slices
+// are received in the first `p * ceil(n / p)` elements of the workspace.
+template <typename T, typename Func>
+std::vector<T> reduce_scatter_(bulk::world& world, const T* xs, std::size_t n,
+                               Func& f, const T* start) {
+  auto p = world.active_processors();
+  auto s = world.rank();
+  auto k = (n + p - 1) / p;
+
+  // (1) Send block `t` of the local values to processor `t`
+  workspace& ws = workspace::of(world, p * k * sizeof(T));
+  auto slices = ws.data<T>();
+  for (int t = 0; t < p; ++t) {
+    auto [first, last] = block_range(n, p, t);
+    if (first == last) {
+      continue;
+    }
+    if (t == s) {
+      std::copy(xs + first, xs + last, slices + s * k);
+    } else {
+      ws.put(t, xs + first, s * k, last - first);
+    }
+  }
+  world.sync();
+
+  // (2) Combine the received slices of the local block in rank order
+  auto [first, last] = block_range(n, p, s);
+  auto block = std::vector<T>(last - first);
+  auto t = 0;
+  if (start) {
+    std::fill(block.begin(), block.end(), *start);
+  } else if (!block.empty()) {
+    std::copy(slices, slices + block.size(), block.begin());
+    ++t;
   }
+  for (; t < p; ++t) {
+    combine_n(block.data(), slices + t * k, block.size(), f);
+  }
+  return block;
+}
 
+// Element-wise reduction of the `n` values at `xs` over all processors, the
+// result is written to `ys` on every processor. This is a reduce-scatter
+// followed by an all-gather, so that each processor sends about `2 * n`
+// values.
+template <typename T, typename Func>
+void allreduce_(bulk::world& world, const T* xs, T* ys, std::size_t n,
+                Func& f, const T* start) {
+  auto p = world.active_processors();
+  auto s = world.rank();
+  auto k = (n + p - 1) / p;
+
+  // The blocks are gathered after the slices of the reduce-scatter
+  workspace& ws = workspace::of(world, (p * k + n) * sizeof(T));
+  auto block = reduce_scatter_(world, xs, n, f, start);
+
+  auto [first, last] = block_range(n, p, s);
+  if (first < last) {
+    for (int t = 0; t < p; ++t) {
+      if (t != s) {
+        ws.put(t, block.data(), p * k + first, block.size());
+      }
+    }
+  }
   world.sync();
 
-  return xs;
+  auto blocks = ws.data<T>() + p * k;
+  std::copy(blocks, blocks + first, ys);
+  std::copy(block.begin(), block.end(), ys + first);
+  std::copy(blocks + last, blocks + n, ys + last);
+}
+
+// Broadcast `n` values of type `T` on `root` to every processor. The values
+// in `[first, last)` are sent to processor `t` with `put(t, first, last)`,
+// after the next sync `receive(first, last)` is called for the values that a
+// processor obtained.
+template <typename T, typename Put, typename Receive>
+void broadcast_(bulk::world& world, std::size_t n, int root, Put put,
+                Receive receive) {
+  auto p = world.active_processors();
+  auto s = world.rank();
+
+  if (n * sizeof(T) <= broadcast_tree_threshold ||
+      n < static_cast<std::size_t>(p)) {
+    // In round `k`, the processors that already hold the data (i.e. those
+    // with a relative rank below 2^k) forward it to the processor 2^k ahead.
+    auto r = (s - root + p) % p;
+    for (int mask = 1; mask < p; mask <<= 1) {
+      if (r < mask && r + mask < p && n > 0) {
+        put((r + mask + root) % p, std::size_t{0}, n);
+      }
+      world.sync();
+      if (r >= mask && r < 2 * mask) {
+        receive(std::size_t{0}, n);
+      }
+    }
+    return;
+  }
+
+  // (1) Scatter the blocks of the root image
+  if (s == root) {
+    for (int t = 0; t < p; ++t) {
+      auto [first, last] = block_range(n, p, t);
+      if (t != root && first < last) {
+        put(t, first, last);
+      }
+    }
+  }
+  world.sync();
+
+  // (2) All-gather the blocks, the root already holds every block
+  auto [first, last] = block_range(n, p, s);
+  if (s != root) {
+    receive(first, last);
+  }
+  if (first < last) {
+    for (int t = 0; t < p; ++t) {
+      if (t != s && t != root) {
+        put(t, first, last);
+      }
+    }
+  }
+  world.sync();
+  if (s != root) {
+    receive(std::size_t{0}, first);
+    receive(last, n);
+  }
+}
+
+// Check (in debug builds) that `n` is the same on every processor
+inline bool same_size_([[maybe_unused]] bulk::world& world,
+                       [[maybe_unused]] std::size_t n,
+                       [[maybe_unused]] const char* caller) {
+#ifndef NDEBUG
+  auto sizes = bulk::gather_all(world, n);
+  for (int t = 1; t < world.active_processors(); ++t) {
+    if (sizes[t] != sizes[0]) {
+      world.log_once("'%s' called with coarray with non-constant size.",
+                     caller);
+      return false;
+    }
+  }
+#endif
+  return true;
+}
+
+// The broadcast of a coarray for backends without a native one
+template <typename T>
+void broadcast_coarray_(bulk::coarray<T>& xs, int root) {
+  broadcast_<T>(
+      xs.world(), xs.size(), root,
+      [&](int t, std::size_t first, std::size_t last) {
+        xs(t)[{first, last}] = std::span<T>(xs.data() + first, last - first);
+      },
+      [](std::size_t, std::size_t) {});
+}
+
+// The broadcast of a span for backends without a native one. The values are
+// forwarded from `xs`, and received in the workspace
+template <typename T>
+void broadcast_span_(bulk::world& world, std::span<T> xs, int root) {
+  auto n = xs.size();
+  detail::workspace& ws = detail::workspace::of(world, n * sizeof(T));
+  auto received = ws.data<T>();
+  broadcast_<T>(
+      world, n, root,
+      [&](int t, std::size_t first, std::size_t last) {
+        ws.put(t, xs.data() + first, first, last - first);
+      },
+      [&](std::size_t first, std::size_t last) {
+        std::copy(received + first, received + last, xs.begin() + first);
+      });
+}
+
+}  // namespace detail
+
+/**
+ * Broadcast the local image of a coarray on `root` to all other images.
+ *
+ * If the backend provides a native broadcast, that is used instead.
+ * Otherwise, small coarrays are forwarded along a binomial tree, so that the
+ * root sends `log p` copies instead of `p`. For large coarrays, the root
+ * scatters the image in `p` blocks, after which every processor sends its
+ * block to all others (van de Geijn). This way, the root sends and each
+ * processor receives about `2 * n` words.
+ *
+ * Requires the local sizes of `xs` to be the same everywhere.
+ *
+ * The cost is `log p * (n * g + l)` for small coarrays, and
+ * `2 * (n * g + l)` for large coarrays, where `n` is the size of the coarray.
+ *
+ * \tparam T the type of the values held by \c xs.
+ *
+ * \param xs the coarray to broadcast
+ * \param root the rank of the processor whose image is broadcast
+ */
+template <typename T>
+void broadcast(bulk::coarray<T>& xs, int root) {
+  auto& world = xs.world();
+  auto n = xs.size();
+
+  if (detail::collectives::broadcast(world, xs.data(), n * sizeof(T), root)) {
+    return;
+  }
+  detail::broadcast_coarray_(xs, root);
+}
+
+/**
+ * Broadcast a contiguous sequence of values on `root` to all other
+ * processors.
+ *
+ * The values are communicated through the scratch space of the world, so
+ * that no coarray is registered. See `broadcast(bulk::coarray<T>&, int)` for
+ * details.
+ *
+ * Requires the sizes of `xs` to be the same everywhere.
+ *
+ * \param world the world in which the broadcast takes place
+ * \param xs the values to broadcast (on `root`), or to overwrite
+ * \param root the rank of the processor whose values are broadcast
+ */
+template <typename T>
+void broadcast(bulk::world& world, std::span<T> xs, int root) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "broadcast only supports trivially-copyable types");
+  auto n = xs.size();
+
+  if (detail::collectives::broadcast(world, xs.data(), n * sizeof(T), root)) {
+    return;
+  }
+  detail::broadcast_span_(world, xs, root);
 }
 
 /**
@@ -124,7 +438,11 @@ S foldl(coarray<T>& xs, Func f, S start_value = {}) {
  *
  * This function applies a function to the images of the elements of a coarray.
  *
- * The cost is `F * p * X + p * g * X + l`, where `F` is the number of
+ * The values are reduced with a reduce-scatter followed by an all-gather, so
+ * that each processor sends and receives about `2 * X` values, instead of
+ * sending its image to every other processor.
+ *
+ * The cost is `F * X + 2 * X * g + 2 * l`, where `F` is the number of
  * flops performed during a single call to `f` and `X` is the size of the
  * coarray.
  *
@@ -144,113 +462,181 @@ template <typename T, typename Func, typename S = T>
 std::vector<T> foldl_each(coarray<T>& xs, Func f, S start_value = {}) {
   auto& world = xs.world();
 
-#ifndef NDEBUG
-  auto sizes = bulk::gather_all(world, xs.size());
-  for (int t = 1; t < world.active_processors(); ++t) {
-    if (sizes[t] != sizes[0]) {
-      world.log_once(
-          "'foldl_each' called with coarray with non-constant "
-          "size.");
-      return {};
+  if (!detail::same_size_(world, xs.size(), "foldl_each")) {
+    return {};
+  }
+
+  auto result = std::vector<T>(xs.size());
+  T start = start_value;
+
+  // The native reductions are associative and commutative, so that the
+  // start value can be combined afterwards
+  if constexpr (detail::reduce_op_of<T, Func>().has_value()) {
+    std::copy(xs.begin(), xs.end(), result.begin());
+    if (detail::native_allreduce_<T, Func>(world, result.data(),
+                                           result.size())) {
+      for (auto& x : result) {
+        x = f(start, x);
+      }
+      return result;
     }
   }
-#endif
 
-  auto result = std::vector<T>(xs.size(), start_value);
+  detail::allreduce_(world, xs.data(), result.data(), xs.size(), f, &start);
 
-  bulk::coarray<T> images(world, world.active_processors() * xs.size());
+  return result;
+}
 
-  for (int t = 0; t < world.active_processors(); ++t) {
-    for (auto i = 0u; i < xs.size(); ++i) {
-      images(t)[i + world.rank() * xs.size()] = xs[i];
-    }
+/**
+ * Reduce the images of a coarray element-wise, and scatter the result.
+ *
+ * The index space `[0, X)` is divided into `p` blocks of (nearly) equal
+ * size, and processor `s` obtains the reduced values of the `s`-th block.
+ *
+ * The cost is `F * X + X * g + l`.
+ *
+ * Requires the local sizes of 'xs' to be the same everywhere.
+ *
+ * \param xs the coarray to reduce
+ * \param f a folding function `(T&, T) -> void`, or a binary operator such
+ * as `std::plus<T>`
+ *
+ * \returns the reduced values of the local block, in which the element with
+ * index `i` is the reduction of the element with index `s * ceil(X / p) + i`.
+ */
+template <typename T, typename Func>
+std::vector<T> reduce_scatter(coarray<T>& xs, Func f) {
+  auto& world = xs.world();
+  if (!detail::same_size_(world, xs.size(), "reduce_scatter")) {
+    return {};
   }
+  return detail::reduce_scatter_(world, xs.data(), xs.size(), f,
+                                 (const T*)nullptr);
+}
 
-  world.sync();
-
-  for (auto i = 0u; i < xs.size(); i++) {
-    for (int t = 0; t < world.active_processors(); ++t) {
-      // apply f iteratively to the current value, and each remote value
-      f(result[i], images[t * xs.size() + i]);
-    }
+/**
+ * Reduce a contiguous sequence of values element-wise over all processors,
+ * in place. See `allreduce(coarray<T>&, Func)` for details.
+ *
+ * \param world the world in which the reduction takes place
+ * \param xs the values to reduce
+ * \param f a folding function `(T&, T) -> void`, or a binary operator such
+ * as `std::plus<T>`
+ */
+template <typename T, typename Func>
+void allreduce(bulk::world& world, std::span<T> xs, Func f) {
+  if (!detail::same_size_(world, xs.size(), "allreduce")) {
+    return;
   }
+  if (detail::native_allreduce_<T, Func>(world, xs.data(), xs.size())) {
+    return;
+  }
+  detail::allreduce_(world, xs.data(), xs.data(), xs.size(), f,
+                     (const T*)nullptr);
+}
 
-  return result;
+/**
+ * Reduce the images of a coarray element-wise, in place.
+ *
+ * Afterwards, the element with index `i` of each image holds the reduction
+ * of the elements with index `i` of all images, combined in rank order.
+ *
+ * This is a reduce-scatter followed by an all-gather, so that each
+ * processor sends and receives about `2 * X` values. The cost is
+ * `F * X + 2 * X * g + 2 * l`. For the arithmetic types and the operators
+ * `std::plus`, `std::multiplies`, `bulk::minimum` and `bulk::maximum`, the
+ * native reduction of the backend is used if it provides one.
+ *
+ * Requires the local sizes of 'xs' to be the same everywhere.
+ *
+ * \param xs the coarray to reduce
+ * \param f a folding function `(T&, T) -> void`, or a binary operator such
+ * as `std::plus<T>`
+ */
+template <typename T, typename Func>
+void allreduce(coarray<T>& xs, Func f) {
+  bulk::allreduce(xs.world(), std::span<T>(xs.data(), xs.size()), f);
 }
 
+namespace detail {
+
+// Reduce a single value over all processors, in rank order
+template <typename T, typename Func>
+T reduce_value_(bulk::world& world, T value, Func f) {
+  if (native_allreduce_<T, Func>(world, &value, 1)) {
+    return value;
+  }
+  auto xs = bulk::gather_all(world, value);
+  return std::accumulate(xs.begin() + 1, xs.end(), xs[0], f);
+}
+
+}  // namespace detail
+
 template <typename T>
 T max(bulk::world& world, T t) {
-  bulk::coarray<T> xs = bulk::gather_all(world, t);
-  return *std::ranges::max_element(xs);
+  return detail::reduce_value_(world, t, bulk::maximum<T>{});
 }
 
 template <typename T>
 T min(bulk::world& world, T t) {
-  auto xs = bulk::gather_all(world, t);
-  return *std::ranges::min_element(xs);
+  return detail::reduce_value_(world, t, bulk::minimum<T>{});
 }
 
 template <typename T>
 T sum(bulk::world& world, T t) {
-  auto xs = bulk::gather_all(world, t);
-  return std::accumulate(xs.begin(), xs.end(), T{});
+  return detail::reduce_value_(world, t, std::plus<T>{});
 }
 
 template <typename T>
 T product(bulk::world& world, T t) {
-  bulk::coarray<T> xs = bulk::gather_all(world, t);
-  return std::accumulate(xs.begin(), xs.end(), (T)1,
-                         [](const T& lhs, const T& rhs) { return lhs * rhs; });
+  return detail::reduce_value_(world, t, std::multiplies<T>{});
 }
 
 template <typename T>
 T max(bulk::var<T>& x) {
-  return bulk::foldl(
-      x, [](auto& lhs, auto& rhs) { lhs = std::max(lhs, rhs); },
-      std::numeric_limits<T>::min());
+  return bulk::max(x.world(), x.value());
 }
 
 template <typename T>
 T min(bulk::var<T>& x) {
-  return bulk::foldl(
-      x, [](auto& lhs, auto& rhs) { lhs = std::min(lhs, rhs); },
-      std::numeric_limits<T>::max());
+  return bulk::min(x.world(), x.value());
 }
 
 template <typename T>
 T sum(bulk::var<T>& x) {
-  return bulk::foldl(x, [](auto& lhs, auto& rhs) { lhs += rhs; });
+  return bulk::sum(x.world(), x.value());
 }
 
 template <typename T>
 T product(bulk::var<T>& x) {
-  return bulk::foldl(
-      x, [](auto& lhs, auto& rhs) { lhs *= rhs; }, (T)1);
+  return bulk::product(x.world(), x.value());
 }
 
 template <typename T>
 T max(bulk::coarray<T>& xs) {
-  return bulk::foldl(
-      xs, [](auto& lhs, auto& rhs) { lhs = std::max(lhs, rhs); },
-      std::numeric_limits<T>::min());
+  return bulk::max(xs.world(),
+                   std::accumulate(xs.begin(), xs.end(),
+                                   std::numeric_limits<T>::lowest(),
+                                   bulk::maximum<T>{}));
 }
 
 template <typename T>
 T min(bulk::coarray<T>& xs) {
-  return bulk::foldl(
-      xs, [](auto& lhs, auto& rhs) { lhs = std::min(lhs, rhs); },
-      std::numeric_limits<T>::max());
+  return bulk::min(xs.world(),
+                   std::accumulate(xs.begin(), xs.end(),
+                                   std::numeric_limits<T>::max(),
+                                   bulk::minimum<T>{}));
 }
 
 template <typename T>
 T sum(bulk::coarray<T>& xs) {
-  return bulk::foldl(xs, [](auto& lhs, auto& rhs) { lhs += rhs; });
+  return bulk::sum(xs.world(), std::accumulate(xs.begin(), xs.end(), T{}));
 }
 
 template <typename T>
 T product(bulk::coarray<T>& xs) {
-  return bulk::foldl(
-      xs, [](auto& lhs, auto& rhs) { lhs *= rhs; }, (T)1);
+  return bulk::product(xs.world(), std::accumulate(xs.begin(), xs.end(), (T)1,
+                                                   std::multiplies<T>{}));
 }
 
 }  // namespace bulk
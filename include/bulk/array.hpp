@@ -131,6 +131,65 @@ class array : var_base {
                 values.size());
   }
 
+  /**
+   * Put strided values into a remote array image.
+   *
+   * The value `values[i * src_stride]` is written to the element
+   * `offset + i * stride` of the remote image, for `0 <= i < count`. The
+   * values are sent as a single record. The cost is `g * count * t`.
+   */
+  void put_strided(int processor, const T* values, size_t src_stride,
+                   size_t offset, size_t stride, size_t count) {
+    world_.put_strided_(processor, values, sizeof(T), src_stride, id_, offset,
+                        stride, count);
+  }
+
+  /**
+   * Put values into a remote array image, at the given indices.
+   *
+   * The value `values[i]` is written to the element `indices[i]` of the
+   * remote image, for `0 <= i < count`. The cost is
+   * `g * count * (t + sizeof(size_t))`.
+   */
+  void put_indexed(int processor, const T* values, const size_t* indices,
+                   size_t count) {
+    world_.put_indexed_(processor, values, sizeof(T), id_, indices, count);
+  }
+
+  /**
+   * Get a future to the elements of a remote array image at the given
+   * indices.
+   *
+   * The cost is `g * count * t`.
+   */
+  future<T[]> get_indexed(int processor, const size_t* indices, size_t count) {
+    future<T[]> result(world_, count);
+    world_.get_indexed_(processor, id_, sizeof(T), result.buffer(), indices,
+                        count);
+    return result;
+  }
+
+  /**
+   * Put the block `src` of `values` into the block `dst` of a remote image.
+   *
+   * The blocks have equal extents. The values are sent as a single record.
+   */
+  void put_block(int processor, const T* values,
+                 const detail::block_layout& src,
+                 const detail::block_layout& dst) {
+    world_.put_block_(processor, values, sizeof(T), src, id_, dst);
+  }
+
+  /**
+   * Get a future to the elements in the block `src` of a remote image,
+   * packed with the first axis contiguous.
+   */
+  future<T[]> get_block(int processor, const detail::block_layout& src) {
+    future<T[]> result(world_, src.count());
+    world_.get_block_(processor, id_, sizeof(T), result.buffer(), src);
+    return result;
+  }
+
   /**
    * Get a future to a remote image of an array element.
    *
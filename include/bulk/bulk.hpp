@@ -12,18 +12,33 @@
 #include <bulk/array.hpp>
 #include <bulk/coarray.hpp>
 #include <bulk/communication.hpp>
+#include <bulk/distributed_unordered_map.hpp>
 #include <bulk/environment.hpp>
 #include <bulk/future.hpp>
+#include <bulk/halo_exchange.hpp>
+#include <bulk/local_view.hpp>
+#include <bulk/map_reduce.hpp>
 #include <bulk/messages.hpp>
 #include <bulk/partitioned_array.hpp>
 #include <bulk/partitionings/block.hpp>
+#include <bulk/partitionings/block_cyclic.hpp>
 #include <bulk/partitionings/cyclic.hpp>
 #include <bulk/partitionings/partitioning.hpp>
+#include <bulk/partitionings/rcb.hpp>
+#include <bulk/partitionings/sfc.hpp>
+#include <bulk/partitionings/slices.hpp>
+#include <bulk/partitionings/static.hpp>
 #include <bulk/partitionings/tree.hpp>
+#include <bulk/redistribute.hpp>
+#include <bulk/sort.hpp>
 #include <bulk/util/binary_tree.hpp>
+#include <bulk/util/divider.hpp>
 #include <bulk/util/fit.hpp>
 #include <bulk/util/indices.hpp>
 #include <bulk/util/report.hpp>
+#include <bulk/util/search.hpp>
+#include <bulk/util/sfc.hpp>
+#include <bulk/util/split_tree.hpp>
 #include <bulk/util/timer.hpp>
 #include <bulk/world.hpp>
 
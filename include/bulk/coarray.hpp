@@ -14,6 +14,7 @@
 
 #include "array.hpp"
 #include "communication.hpp"
+#include "util/slice.hpp"
 
 namespace bulk {
 
@@ -254,6 +255,71 @@ class coarray {
     data_.put(processor, first, last, offset);
   }
 
+  /**
+   * Put strided values in a remote image.
+   *
+   * The value `values[i * stride]` is written to element
+   * `dst_offset + i * dst_stride` on processor `t`, for `0 <= i < count`,
+   * e.g. to send a row of a column-major matrix. The values are sent as a
+   * single record, instead of one per element.
+   */
+  void put_strided(int t, const T* values, size_t stride, size_t dst_offset,
+                   size_t dst_stride, size_t count) {
+    data_.put_strided(t, values, stride, dst_offset, dst_stride, count);
+  }
+
+  /**
+   * Put values at the given indices of a remote image.
+   *
+   * The value `values[i]` is written to element `indices[i]` on processor
+   * `t`. The values are sent as a single record.
+   */
+  void put_indexed(int t, std::span<const T> values,
+                   std::span<const size_t> indices) {
+    assert(values.size() == indices.size());
+    data_.put_indexed(t, values.data(), indices.data(), indices.size());
+  }
+
+  /**
+   * Get a future to the elements at the given indices of a remote image.
+   *
+   * Element `i` of the future becomes the value of element `indices[i]` on
+   * processor `t`.
+   */
+  future<T[]> get_indexed(int t, std::span<const size_t> indices) {
+    return data_.get_indexed(t, indices.data(), indices.size());
+  }
+
+  /**
+   * Put a multi-dimensional block in a remote image.
+   *
+   * The elements of the slice `src` of `values` are written to the slice
+   * `dst` of the image of processor `t`, which must have the same extents.
+   * The block is sent as a single record, e.g.:
+   *
+   *     // put the 2 x 3 block at (1, 1) of the local 4 x 4 image, to (0, 2)
+   *     // on processor t
+   *     xs.put(t, xs.data(), bulk::nd_slice<2>::in({4, 4}, {1, 1}, {2, 3}),
+   *            bulk::nd_slice<2>::in({4, 4}, {0, 2}, {2, 3}));
+   */
+  template <int D>
+  void put(int t, const T* values, const nd_slice<D>& src,
+           const nd_slice<D>& dst) {
+    assert(src.extent == dst.extent);
+    data_.put_block(t, values, src.layout(), dst.layout());
+  }
+
+  /**
+   * Get a future to a multi-dimensional block of a remote image.
+   *
+   * The elements of the future are those of the slice `src` of the image
+   * of processor `t`, packed with the first axis contiguous.
+   */
+  template <int D>
+  future<T[]> get(int t, const nd_slice<D>& src) {
+    return data_.get_block(t, src.layout());
+  }
+
   /**
    * Get a future to the value of element `idx` on processor `t`.
    */
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "future.hpp"
+#include "messages.hpp"
+#include "util/flat_map.hpp"
+#include "util/serialize.hpp"
+#include "world.hpp"
+
+/**
+ * \file distributed_unordered_map.hpp
+ *
+ * This header provides a hash map whose entries are distributed over the
+ * processors by the hash of their key.
+ */
+
+namespace bulk {
+
+namespace detail {
+
+// The processor among `p` that owns a key with hash `hash`. The hash is mixed
+// (splitmix64) first, so that the bits used by the local tables are not the
+// same for all keys of a processor
+inline int hash_owner_(std::uint64_t hash, int p) {
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return static_cast<int>(hash % p);
+}
+
+}  // namespace detail
+
+/**
+ * A distributed hash map, whose keys are partitioned over the processors by
+ * their hash. Each processor stores the entries it owns in a
+ * `bulk::util::flat_map`.
+ *
+ * Updates and lookups are not communicated immediately, but collected per
+ * destination, and sent as a single message per destination at the next
+ * `sync` of the world. Updates for the same key from the same processor are
+ * already combined before they are sent, as in a `combining_queue`. The
+ * updates are applied on receipt, in the order: inserts, upserts, combines.
+ * If several processors update the same key in the same superstep, the
+ * order in which their updates are applied is unspecified.
+ *
+ * A lookup is answered at the sync after the one at which it is sent, so
+ * that it sees all updates of the superstep in which it was made. The
+ * results are therefore available after two synchronizations, e.g. after
+ * `map.sync()`.
+ *
+ *     auto counts = bulk::distributed_unordered_map<std::string, int>(world);
+ *     counts.combine("apple", 1);
+ *     auto apples = counts.find("apple");
+ *     counts.sync();
+ *     // apples.value() == p
+ *
+ * \tparam Key the type of the keys
+ * \tparam Value the type of the values
+ * \tparam Combine the function used to combine values in `combine`, either
+ * `(Value&, Value) -> void` or a binary operator
+ * \tparam Hash the hash function for the keys
+ * \tparam Equal the equality predicate for the keys
+ */
+template <typename Key, typename Value, typename Combine = std::plus<Value>,
+          typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+class distributed_unordered_map {
+ public:
+  using local_type = util::flat_map<Key, Value, Hash, Equal>;
+
+  /** Construct an empty map, and register it with `world`. */
+  distributed_unordered_map(bulk::world& world, Combine combine = {}) {
+    impl_ = std::make_unique<impl>(world, combine);
+  }
+
+  // Disallow copies
+  distributed_unordered_map(distributed_unordered_map& other) = delete;
+  void operator=(distributed_unordered_map& other) = delete;
+
+  /** Move a map. */
+  distributed_unordered_map(distributed_unordered_map&& other) {
+    impl_ = std::move(other.impl_);
+  }
+
+  /** Move a map. */
+  void operator=(distributed_unordered_map&& other) {
+    impl_ = std::move(other.impl_);
+  }
+
+  /** The processor that owns `key`. */
+  int owner(const Key& key) const { return impl_->owner_(key); }
+
+  /** Insert `value` for `key` at the next sync, unless `key` is present. */
+  void insert(const Key& key, Value value) {
+    impl_->outgoing_[owner(key)].inserts.try_emplace(key, std::move(value));
+  }
+
+  /** Set the value for `key` to `value` at the next sync. */
+  void upsert(const Key& key, Value value) {
+    impl_->outgoing_[owner(key)].upserts[key] = std::move(value);
+  }
+
+  /**
+   * Combine `value` into the value for `key` at the next sync, or insert it
+   * if `key` is not present.
+   */
+  void combine(const Key& key, Value value) {
+    impl_->outgoing_[owner(key)].combines.combine(key, std::move(value),
+                                                   impl_->combine_);
+  }
+
+  /**
+   * Look up the value for `key`. The future holds the value, or `nullopt` if
+   * `key` is not present, after the second sync from now. The future has to
+   * be kept alive until then.
+   */
+  bulk::future<std::optional<Value>> find(const Key& key) {
+    auto result = bulk::future<std::optional<Value>>(world());
+    impl_->request_(key, &result.value());
+    return result;
+  }
+
+  /**
+   * Look up the values for a batch of keys, without a future per key.
+   * `results[i]` holds the value for `keys[i]`, or `nullopt`, after the second
+   * sync from now. The results have to be kept alive until then.
+   */
+  void find(std::span<const Key> keys,
+            std::span<std::optional<Value>> results) {
+    assert(results.size() >= keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      impl_->request_(keys[i], &results[i]);
+    }
+  }
+
+  /**
+   * Synchronize the world twice, so that all updates are applied and all
+   * lookups are answered.
+   */
+  void sync() {
+    world().sync();
+    world().sync();
+  }
+
+  /** The entries owned by this processor. */
+  local_type& local() { return impl_->local_; }
+
+  /** The number of entries owned by this processor. */
+  std::size_t local_size() const { return impl_->local_.size(); }
+
+  /** Get a reference to the world of the map. */
+  bulk::world& world() { return impl_->world_; }
+
+ private:
+  // The messages for a single destination
+  struct outbox {
+    util::flat_map<Key, Value, Hash, Equal> inserts;
+    util::flat_map<Key, Value, Hash, Equal> upserts;
+    util::flat_map<Key, Value, Hash, Equal> combines;
+    // lookups, with the index of their result on the sender
+    std::vector<std::pair<Key, std::size_t>> requests;
+    // answers to lookups, with the index of their result on the receiver
+    std::vector<std::pair<std::size_t, std::optional<Value>>> replies;
+
+    bool empty() const {
+      return inserts.empty() && upserts.empty() && combines.empty() &&
+             requests.empty() && replies.empty();
+    }
+  };
+
+  class impl : public queue_base {
+   public:
+    impl(bulk::world& world, Combine combine)
+        : outgoing_(world.active_processors()),
+          received_(world.active_processors()),
+          combine_(combine),
+          world_(world) {
+      id_ = world.register_queue_(this);
+    }
+    ~impl() { world_.unregister_queue_(id_); }
+
+    // No copies or moves
+    impl(impl& other) = delete;
+    impl(impl&& other) = delete;
+    void operator=(impl& other) = delete;
+    void operator=(impl&& other) = delete;
+
+    int owner_(const Key& key) const {
+      return detail::hash_owner_(Hash{}(key), world_.active_processors());
+    }
+
+    void request_(const Key& key, std::optional<Value>* result) {
+      outgoing_[owner_(key)].requests.emplace_back(key, requested_.size());
+      requested_.push_back(result);
+    }
+
+    // The lookups received at the previous sync are answered, and all
+    // messages for a destination are sent as a single message
+    void flush_() override {
+      auto p = world_.active_processors();
+      for (int t = 0; t < p; ++t) {
+        for (auto& [key, index] : received_[t]) {
+          auto value = local_.find(key);
+          outgoing_[t].replies.emplace_back(
+              index, value ? std::optional<Value>(*value) : std::nullopt);
+        }
+        received_[t].clear();
+      }
+      // Replies that arrive at this sync are for the lookups sent at the
+      // previous sync
+      answering_ = std::move(sent_);
+      sent_ = std::move(requested_);
+      requested_.clear();
+
+      for (int t = 0; t < p; ++t) {
+        auto& box = outgoing_[t];
+        if (box.empty()) {
+          continue;
+        }
+
+        auto size = std::size_t{0};
+        auto count = [&](auto& entries) {
+          size += bulk::detail::serialized_size(entries.size());
+          for (auto& [key, value] : entries) {
+            size += bulk::detail::serialized_size(key, value);
+          }
+        };
+        count(box.inserts);
+        count(box.upserts);
+        count(box.combines);
+        size += bulk::detail::serialized_size(world_.rank());
+        count(box.requests);
+        count(box.replies);
+
+        auto target_buffer = world_.send_buffer_(t, id_, size);
+        auto membuf = bulk::detail::memory_buffer_base(target_buffer);
+        auto ibuf = bulk::detail::imembuf(membuf);
+        auto write = [&](auto& entries) {
+          membuf << entries.size();
+          for (auto& [key, value] : entries) {
+            bulk::detail::fill(ibuf, key, value);
+          }
+          entries.clear();
+        };
+        write(box.inserts);
+        write(box.upserts);
+        write(box.combines);
+        membuf << world_.rank();
+        write(box.requests);
+        write(box.replies);
+      }
+    }
+
+    // The world does not tell the sender of a message, so it is sent along
+    // with the lookups
+    void deserialize_push(size_t, char* data) override {
+      auto membuf = bulk::detail::memory_buffer_base(data);
+      auto obuf = bulk::detail::omembuf(membuf);
+      auto read = [&](auto f) {
+        size_t count = 0;
+        membuf >> count;
+        for (size_t i = 0; i < count; ++i) {
+          f();
+        }
+      };
+      auto key = Key{};
+      auto value = Value{};
+      read([&] {
+        bulk::detail::fill(obuf, key, value);
+        local_.try_emplace(key, value);
+      });
+      read([&] {
+        bulk::detail::fill(obuf, key, value);
+        local_[key] = value;
+      });
+      read([&] {
+        bulk::detail::fill(obuf, key, value);
+        local_.combine(key, value, combine_);
+      });
+      auto sender = 0;
+      membuf >> sender;
+      read([&] {
+        auto index = std::size_t{0};
+        bulk::detail::fill(obuf, key, index);
+        received_[sender].emplace_back(key, index);
+      });
+      read([&] {
+        auto index = std::size_t{0};
+        auto result = std::optional<Value>{};
+        bulk::detail::fill(obuf, index, result);
+        *answering_[index] = std::move(result);
+      });
+    }
+
+    // The entries and lookups persist between supersteps
+    void clear_() override {}
+
+    std::vector<outbox> outgoing_;
+    // the lookups received from each processor at the last sync
+    std::vector<std::vector<std::pair<Key, std::size_t>>> received_;
+    // the results of the lookups made in this superstep, of those sent at the
+    // last sync, and of those that are answered at this sync
+    std::vector<std::optional<Value>*> requested_;
+    std::vector<std::optional<Value>*> sent_;
+    std::vector<std::optional<Value>*> answering_;
+    local_type local_;
+    Combine combine_;
+    bulk::world& world_;
+    int id_;
+  };
+  std::unique_ptr<impl> impl_;
+};
+
+}  // namespace bulk
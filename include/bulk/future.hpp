@@ -1,7 +1,9 @@
 #pragma once
 
 #include <bulk/world.hpp>
+#include <cstring>
 #include <memory>
+#include <type_traits>
 
 #include "util/meta_helpers.hpp"
 #include "util/serialize.hpp"
@@ -87,10 +89,16 @@ class future {
     void operator=(impl& other) = delete;
     void operator=(impl&& other) = delete;
 
-    void deserialize_get(size_t size, char* data) override final {
-      auto membuf = bulk::detail::memory_buffer(size, data);
-      auto obuf = bulk::detail::omembuf(membuf);
-      bulk::detail::fill(obuf, buffer_);
+    void deserialize_get([[maybe_unused]] size_t size,
+                         char* data) override final {
+      if constexpr (std::is_trivially_copyable_v<value_type>) {
+        memcpy(&buffer_, data, size);
+      } else {
+        // use non-owning memory buffer, decoding directly from `data`
+        auto membuf = bulk::detail::memory_buffer_base(data);
+        auto obuf = bulk::detail::omembuf(membuf);
+        bulk::detail::fill(obuf, buffer_);
+      }
     }
 
     int id() const override final { return id_; }
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "coarray.hpp"
+#include "partitionings/block.hpp"
+#include "util/indices.hpp"
+#include "util/slice.hpp"
+#include "world.hpp"
+
+/**
+ * \file halo_exchange.hpp
+ *
+ * This header provides the exchange of ghost cells between the blocks of a
+ * block partitioning, as needed by stencil computations.
+ */
+
+namespace bulk {
+
+/**
+ * A plan for exchanging the ghost cells (halo) of the local blocks of a
+ * block partitioning.
+ *
+ * The local block of each processor is stored in a coarray, padded with
+ * `radius` ghost cells on both sides of each axis, and flattened as by
+ * `bulk::util::flatten`. A cell with local index `x` in the block is at
+ * padded index `x + radius`. An exchange copies the cells near the boundary
+ * of each block into the ghost cells of the neighbouring blocks, including
+ * the edge and corner regions if `corners` is set (as needed by e.g. a
+ * 27-point stencil in 3D). Ghost cells on the global boundary are left
+ * untouched, so that they can hold boundary values.
+ *
+ * The regions and their neighbours are computed once, and each region is
+ * sent as a single multi-dimensional slice. An exchange takes a single
+ * superstep:
+ *
+ *     auto halo = bulk::halo_exchange<double, 3>(world, partitioning, 1);
+ *     auto u = halo.field();
+ *     // ... initialize u
+ *     halo.start(u);
+ *     // ... compute on cells that do not depend on ghost cells
+ *     world.sync();
+ *     // ... compute on the remaining cells
+ *
+ * \tparam T the type of the cells
+ * \tparam D the dimension of the data
+ * \tparam G the dimension of the processor grid
+ */
+template <typename T, int D, int G = D>
+class halo_exchange {
+ public:
+  /**
+   * Construct the plan for the local block of `partitioning`.
+   *
+   * \param radius the number of ghost cells on each side, which is at most
+   * the local size of each block along each partitioned axis
+   * \param corners whether to also exchange the diagonal (edge and corner)
+   * regions, instead of only the faces
+   */
+  halo_exchange(bulk::world& world, block_partitioning<D, G>& partitioning,
+                size_t radius, bool corners = true)
+      : world_(world), radius_(radius) {
+    auto grid = partitioning.grid();
+    auto axes = partitioning.axes();
+    auto me = partitioning.multi_rank(world.rank());
+    auto size = partitioning.local_size(me);
+    shape_ = padded_(size);
+
+    // Loop over the 3^G offsets of the neighbours in the processor grid
+    auto offsets = index_type<G>{};
+    for (int i = 0; i < G; ++i) {
+      offsets[i] = 3;
+    }
+    auto neighbours = size_t{1};
+    for (int i = 0; i < G; ++i) {
+      neighbours *= 3;
+    }
+    for (size_t n = 0; n < neighbours; ++n) {
+      auto offset = util::unflatten<G>(offsets, n);
+      auto target = me;
+      auto nonzero = 0;
+      auto valid = true;
+      for (int i = 0; i < G; ++i) {
+        // offset[i] is 0, 1 or 2 for a neighbour below, aligned or above
+        nonzero += offset[i] != 1;
+        if ((offset[i] == 0 && me[i] == 0) ||
+            (offset[i] == 2 && me[i] + 1 == grid[i])) {
+          valid = false;
+        }
+        target[i] = me[i] + offset[i] - 1;
+      }
+      if (nonzero == 0 || !valid || (!corners && nonzero > 1)) {
+        continue;
+      }
+
+      auto target_size = partitioning.local_size(target);
+      auto src = nd_slice<D>::in(shape_, {}, {});
+      auto dst = nd_slice<D>::in(padded_(target_size), {}, {});
+      for (int d = 0; d < D; ++d) {
+        src.origin[d] = radius_;
+        src.extent[d] = size[d];
+        dst.origin[d] = radius_;
+      }
+      for (int i = 0; i < G; ++i) {
+        auto d = axes[i];
+        assert(size[d] >= radius_ && target_size[d] >= radius_);
+        if (offset[i] == 0) {
+          // our first cells become the last ghost cells of the target
+          src.extent[d] = radius_;
+          dst.origin[d] = radius_ + target_size[d];
+        } else if (offset[i] == 2) {
+          // our last cells become the first ghost cells of the target
+          src.origin[d] = size[d];
+          src.extent[d] = radius_;
+          dst.origin[d] = 0;
+        }
+      }
+      dst.extent = src.extent;
+      regions_.push_back({partitioning.rank(target), src, dst});
+    }
+  }
+
+  /**
+   * Send the boundary cells of the local block of `field` to the ghost cells
+   * of the neighbouring blocks. The ghost cells are updated at the next
+   * synchronization, and the boundary cells should not be modified until
+   * then.
+   */
+  void start(bulk::coarray<T>& field) {
+    assert(field.size() == size());
+    for (auto& region : regions_) {
+      field.put(region.target, field.data(), region.src, region.dst);
+    }
+  }
+
+  /** Exchange the ghost cells of `field`, which ends the superstep. */
+  void exchange(bulk::coarray<T>& field) {
+    start(field);
+    world_.sync();
+  }
+
+  /** Construct a coarray that holds the padded local block. */
+  bulk::coarray<T> field(T value = {}) {
+    return bulk::coarray<T>(world_, size(), value);
+  }
+
+  /** The shape of the padded local block. */
+  index_type<D> shape() const { return shape_; }
+
+  /** The number of cells of the padded local block. */
+  size_t size() const {
+    size_t result = 1;
+    for (int d = 0; d < D; ++d) {
+      result *= shape_[d];
+    }
+    return result;
+  }
+
+  /** The index in the padded local block of the cell with padded multi-index
+   * `xs`. */
+  size_t index(index_type<D> xs) const {
+    return util::flatten<D>(shape_, xs);
+  }
+
+  /** The number of ghost cells on each side. */
+  size_t radius() const { return radius_; }
+
+  /** The number of neighbouring regions that are sent in an exchange. */
+  size_t regions() const { return regions_.size(); }
+
+ private:
+  struct region {
+    int target;
+    nd_slice<D> src;
+    nd_slice<D> dst;
+  };
+
+  index_type<D> padded_(index_type<D> size) const {
+    for (int d = 0; d < D; ++d) {
+      size[d] += 2 * radius_;
+    }
+    return size;
+  }
+
+  bulk::world& world_;
+  size_t radius_;
+  index_type<D> shape_;
+  std::vector<region> regions_;
+};
+
+}  // namespace bulk
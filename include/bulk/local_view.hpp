@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "coarray.hpp"
+#include "partitionings/partitioning.hpp"
+#include "util/indices.hpp"
+
+/**
+ * \file local_view.hpp
+ *
+ * This header provides a multi-dimensional view of the local image of a
+ * coarray, in the spirit of `std::mdspan`.
+ */
+
+namespace bulk {
+
+/**
+ * The layout of a view where the first axis is contiguous, as
+ * `bulk::util::flatten`. For a matrix indexed as `{row, column}`, this is
+ * column-major order.
+ */
+struct layout_left {};
+
+/**
+ * The layout of a view where the last axis is contiguous. For a matrix indexed
+ * as `{row, column}`, this is row-major order.
+ */
+struct layout_right {};
+
+/**
+ * A non-owning `D`-dimensional view of contiguous local elements.
+ *
+ * The extents and strides are computed once, when the view is constructed,
+ * and the stride of the contiguous axis is the constant one. Indexing is
+ * therefore a dot product of the indices with the strides, without calls into
+ * a partitioning, so that loops along the contiguous axis compile to plain
+ * pointer increments and can be vectorized.
+ *
+ *     auto part = bulk::block_partitioning<2>({n, n}, {2, 2});
+ *     auto xs = bulk::coarray<double>(world, part.local_count(world.rank()));
+ *     auto a = bulk::local_view<double, 2>(xs, part);
+ *     for (size_t j = 0; j < a.extent(1); ++j) {
+ *       for (size_t i = 0; i < a.extent(0); ++i) {
+ *         a(i, j) = 1.0;
+ *       }
+ *     }
+ *
+ * Like a span, the view does not propagate its constness to the elements, use
+ * `local_view<const T, D>` for a read-only view.
+ */
+template <typename T, int D, typename Layout = layout_left>
+class local_view {
+  static_assert(std::is_same_v<Layout, layout_left> ||
+                    std::is_same_v<Layout, layout_right>,
+                "The layout should be bulk::layout_left or bulk::layout_right");
+
+ public:
+  using element_type = T;
+  using layout_type = Layout;
+
+  /** The number of axes of the view. */
+  static constexpr int rank() { return D; }
+
+  /** Construct an empty view. */
+  local_view() = default;
+
+  /**
+   * Construct a view of the `D`-dimensional array of size `extents` stored at
+   * `data`.
+   */
+  local_view(T* data, index_type<D> extents) : data_(data) {
+    size_t stride = 1;
+    for (int k = 0; k < D; ++k) {
+      auto d = std::is_same_v<Layout, layout_left> ? k : D - 1 - k;
+      extents_[d] = extents[d];
+      strides_[d] = stride;
+      stride *= extents[d];
+    }
+  }
+
+  /**
+   * Construct a view of the local image of `xs`, with the local size of the
+   * local processor in the partitioning `part`. The partitioning is only used
+   * here, and does not have to outlive the view.
+   */
+  template <int G>
+  local_view(bulk::coarray<std::remove_const_t<T>>& xs,
+             multi_partitioning<D, G>& part)
+      : local_view(xs.data(),
+                   part.local_size(part.multi_rank(xs.world().rank()))) {
+    assert(size() == xs.size());
+  }
+
+  /** Get the element with local indices `idxs...`. */
+  template <typename... Idxs>
+    requires(sizeof...(Idxs) == D && (std::is_integral_v<Idxs> && ...))
+  T& operator()(Idxs... idxs) const {
+    return data_[offset_(std::array<size_t, D>{static_cast<size_t>(idxs)...})];
+  }
+
+  /** Get the element with local index `index`. */
+  T& operator[](index_type<D> index) const { return data_[offset_(index)]; }
+
+  /** The number of elements along axis `d`. */
+  size_t extent(int d) const { return extents_[d]; }
+
+  /** The number of elements along each axis. */
+  index_type<D> extents() const {
+    index_type<D> result = {};
+    for (int d = 0; d < D; ++d) {
+      result[d] = extents_[d];
+    }
+    return result;
+  }
+
+  /** The distance between consecutive elements along axis `d`. */
+  size_t stride(int d) const { return strides_[d]; }
+
+  /** The total number of elements. */
+  size_t size() const {
+    size_t result = 1;
+    for (int d = 0; d < D; ++d) {
+      result *= extents_[d];
+    }
+    return result;
+  }
+
+  /** The elements, stored contiguously. */
+  T* data() const { return data_; }
+
+  /** The elements as a flat span, in storage order. */
+  std::span<T> span() const { return {data_, size()}; }
+
+ private:
+  // The axis with stride one
+  static constexpr int contiguous_ =
+      std::is_same_v<Layout, layout_left> ? 0 : D - 1;
+
+  template <typename Index>
+  size_t offset_(const Index& index) const {
+    size_t result = index[contiguous_];
+    for (int d = 0; d < D; ++d) {
+      if (d != contiguous_) {
+        result += index[d] * strides_[d];
+      }
+    }
+    return result;
+  }
+
+  T* data_ = nullptr;
+  std::array<size_t, D> extents_ = {};
+  std::array<size_t, D> strides_ = {};
+};
+
+}  // namespace bulk
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "distributed_unordered_map.hpp"
+#include "messages.hpp"
+#include "util/flat_map.hpp"
+#include "world.hpp"
+
+/**
+ * \file map_reduce.hpp
+ *
+ * This header provides a MapReduce pipeline, and a gather of sorted results
+ * along a tree.
+ */
+
+namespace bulk {
+
+/** Options for `bulk::map_reduce`. */
+struct map_reduce_options {
+  /**
+   * The maximum number of distinct keys in the combiner for a single
+   * destination. A full combiner is written to the outgoing messages and
+   * cleared, at the cost of sending a key more than once. This only caps the
+   * memory of the combiners: the messages are all sent at the single
+   * synchronization of the shuffle, so they are buffered in full.
+   */
+  std::size_t max_combiner_size = std::size_t{1} << 16;
+};
+
+/**
+ * Map the local inputs to key-value pairs, and reduce the values of equal keys
+ * over all processors.
+ *
+ * The map function is called as `map(input, emit)` for each local input, and
+ * calls `emit(key, value)` for each pair that it produces. The pairs are
+ * combined per destination by a local combiner as they are emitted, and the
+ * combined pairs are sent to the processor that owns their key, given by the
+ * hash of the key. Each processor reduces the pairs that it receives, so that
+ * the reduce phase is parallel, and returns the reduced pairs of the keys it
+ * owns, in an unspecified order.
+ *
+ *     auto counts = bulk::map_reduce<std::string, int>(
+ *         world, lines, [](const std::string& line, auto& emit) {
+ *           for (auto word : split(line)) {
+ *             emit(word, 1);
+ *           }
+ *         });
+ *
+ * The cost is about `M + n * g + l`, where `M` is the time spent in the map
+ * function, and `n` the number of combined pairs that a processor sends or
+ * receives.
+ *
+ * \tparam Key the type of the keys
+ * \tparam Value the type of the values
+ * \tparam Reduce the function used to reduce two values with the same key,
+ * either `(Value&, Value) -> void` or a binary operator such as
+ * `std::plus<Value>`. The values are reduced in an unspecified order, so it
+ * should be associative and commutative.
+ *
+ * \param world the world in which the pairs are reduced
+ * \param inputs a range of local inputs
+ * \param map the map function
+ * \param reduce the reduce function
+ * \param options the combining options
+ *
+ * \returns the reduced pairs of the keys owned by this processor
+ */
+template <typename Key, typename Value, typename Range, typename Map,
+          typename Reduce = std::plus<Value>>
+std::vector<std::pair<Key, Value>> map_reduce(bulk::world& world,
+                                              Range&& inputs, Map map,
+                                              Reduce reduce = {},
+                                              map_reduce_options options = {}) {
+  auto p = world.active_processors();
+
+  // (1) Map the inputs, combining the pairs per destination
+  auto shuffle = bulk::queue<Key, Value>(world);
+  auto combiners = std::vector<util::flat_map<Key, Value>>(p);
+  auto flush = [&](int t) {
+    for (auto& [key, value] : combiners[t]) {
+      shuffle(t).send(key, value);
+    }
+    combiners[t].clear();
+  };
+  auto emit = [&](const Key& key, Value value) {
+    auto t = detail::hash_owner_(std::hash<Key>{}(key), p);
+    combiners[t].combine(key, std::move(value), reduce);
+    if (combiners[t].size() >= options.max_combiner_size) {
+      flush(t);
+    }
+  };
+  for (auto&& input : inputs) {
+    map(input, emit);
+  }
+  for (int t = 0; t < p; ++t) {
+    flush(t);
+  }
+  world.sync();
+
+  // (2) Reduce the received pairs
+  auto reduced = util::flat_map<Key, Value>(shuffle.size());
+  for (auto& [key, value] : shuffle) {
+    reduced.combine(key, std::move(value), reduce);
+  }
+  return std::vector<std::pair<Key, Value>>(
+      std::make_move_iterator(reduced.begin()),
+      std::make_move_iterator(reduced.end()));
+}
+
+/**
+ * Gather the values of all processors on the first processor, in sorted
+ * order.
+ *
+ * Each processor sorts its own values. The sorted runs are then merged along
+ * a binomial tree: in round `k`, a processor whose rank is an odd multiple of
+ * `2^k` sends its merged run to the processor `2^k` below it. This way, the
+ * first processor receives `log p` runs instead of `p`, and the merging is
+ * shared by the processors.
+ *
+ * The cost is about `(n / p) log(n / p) + log p * (n * g + l)` in the worst
+ * case, for `n` values in all.
+ *
+ * \param world the world in which the values are gathered
+ * \param xs the local values
+ * \param comp the ordering of the values
+ *
+ * \returns all values in sorted order on the first processor, and an empty
+ * vector on the other processors
+ */
+template <typename T, typename Compare = std::less<>>
+std::vector<T> gather_sorted(bulk::world& world, std::vector<T> xs,
+                             Compare comp = {}) {
+  auto p = world.active_processors();
+  auto s = world.rank();
+
+  std::sort(xs.begin(), xs.end(), comp);
+  auto q = bulk::queue<T>(world);
+  for (int mask = 1; mask < p; mask <<= 1) {
+    if (s % (2 * mask) == mask) {
+      for (auto& x : xs) {
+        q(s - mask).send(x);
+      }
+      xs.clear();
+    }
+    world.sync();
+    if (s % (2 * mask) == 0 && !q.empty()) {
+      // The order of the received messages is not specified, so the received
+      // run is sorted unless it already is
+      auto middle = xs.size();
+      xs.insert(xs.end(), std::make_move_iterator(q.begin()),
+                std::make_move_iterator(q.end()));
+      if (!std::is_sorted(xs.begin() + middle, xs.end(), comp)) {
+        std::sort(xs.begin() + middle, xs.end(), comp);
+      }
+      std::inplace_merge(xs.begin(), xs.begin() + middle, xs.end(), comp);
+    }
+  }
+  return xs;
+}
+
+}  // namespace bulk
@@ -3,10 +3,15 @@
 #include <cstddef>
 #include <cstring>
 #include <memory>
+#include <span>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "util/flat_map.hpp"
 #include "util/meta_helpers.hpp"
+#include "util/reduce.hpp"
 #include "util/serialize.hpp"
 #include "world.hpp"
 
@@ -31,11 +36,19 @@ class queue_base {
 
   virtual void clear_() = 0;
   virtual void deserialize_push(size_t size, char* data) = 0;
+
+  // Called by the backend at the start of a sync, so that queues that hold
+  // back outgoing messages can send them
+  virtual void flush_() {}
 };
 
 /**
  * The queue inferface is used for sending and receiving messages.
  *
+ * Components of type `std::string_view` or `std::span<const T>` are received
+ * into storage owned by the queue, so that the received messages hold views
+ * that are valid until the queue is cleared.
+ *
  * \tparam Tag the type to use for the message tag
  * \tparam Content the type to use for the message content
  */
@@ -54,10 +67,40 @@ class queue {
   class sender {
    public:
     /** Send a message over the queue. */
-    void send(typename representation<Ts>::type... args) {
+    void send(const typename representation<Ts>::type&... args) {
       q_.impl_->send_(t_, args...);
     }
 
+    /**
+     * Send a message over the queue, passing array components as spans.
+     *
+     * The elements are serialized directly from the span, so that e.g. a
+     * block of a larger array is sent without first copying it into a vector:
+     *
+     *     q(processor).send(std::span(xs).subspan(offset, count));
+     */
+    void send(typename view_representation<Ts>::type... args)
+      requires(std::is_unbounded_array_v<Ts> || ...)
+    {
+      q_.impl_->send_(t_, args...);
+    }
+
+    /**
+     * Send a message of `count` elements over a queue of arrays, writing the
+     * elements in place.
+     *
+     * The message is reserved in the outgoing buffer, and `f` is called with
+     * the `count * sizeof(T)` bytes for its elements, as a
+     * `std::span<std::byte>`. These bytes are not necessarily aligned for
+     * `T`, so they should be written with e.g. `std::memcpy`, and only until
+     * the next message is sent.
+     */
+    template <typename Func>
+      requires(sizeof...(Ts) == 1 && (std::is_unbounded_array_v<Ts> && ...))
+    void send_with(size_t count, Func&& f) {
+      q_.impl_->send_with_(t_, count, f);
+    }
+
    private:
     friend queue;
 
@@ -139,25 +182,362 @@ class queue {
     void operator=(impl& other) = delete;
     void operator=(impl&& other) = delete;
 
-    void send_(int t, typename representation<Ts>::type... args) {
-      bulk::detail::scale ruler;
-      bulk::detail::fill(ruler, args...);
-      auto target_buffer = world_.send_buffer_(t, id_, ruler.size);
+    template <typename... Us>
+    void send_(int t, const Us&... args) {
+      auto size = bulk::detail::serialized_size(args...);
+      auto target_buffer = world_.send_buffer_(t, id_, size);
       auto membuf = bulk::detail::memory_buffer_base(target_buffer);
       auto ibuf = bulk::detail::imembuf(membuf);
       bulk::detail::fill(ibuf, args...);
     }
 
+    template <typename Func>
+    void send_with_(int t, size_t count, Func& f) {
+      using T =
+          std::remove_extent_t<std::tuple_element_t<0, std::tuple<Ts...>>>;
+      static_assert(std::is_trivially_copyable_v<T>,
+                    "Only arrays of trivially copyable types can be written "
+                    "in place");
+      auto target_buffer = static_cast<char*>(
+          world_.send_buffer_(t, id_, sizeof(int) + count * sizeof(T)));
+      auto n = static_cast<int>(count);
+      memcpy(target_buffer, &n, sizeof(int));
+      f(std::span<std::byte>(
+          reinterpret_cast<std::byte*>(target_buffer + sizeof(int)),
+          count * sizeof(T)));
+    }
+
     void deserialize_push(size_t, char* data) override {
       auto membuf = bulk::detail::memory_buffer_base(data);
       data_.push_back(message_type{});
-      auto obuf = bulk::detail::omembuf(membuf);
-      bulk::detail::fill(obuf, data_[data_.size() - 1]);
+      if constexpr ((bulk::detail::view<Ts> || ...)) {
+        auto obuf = bulk::detail::arena_omembuf(membuf, arena_);
+        bulk::detail::fill(obuf, data_[data_.size() - 1]);
+      } else {
+        auto obuf = bulk::detail::omembuf(membuf);
+        bulk::detail::fill(obuf, data_[data_.size() - 1]);
+      }
     }
 
-    void clear_() override { data_.clear(); }
+    void clear_() override {
+      data_.clear();
+      arena_.clear();
+    }
 
     std::vector<message_type> data_;
+    // Holds the content of the views in the received messages
+    bulk::detail::arena arena_;
+    bulk::world& world_;
+    int id_;
+  };
+  std::unique_ptr<impl> impl_;
+
+  friend sender;
+};
+
+/**
+ * A queue that stores the received messages as a structure of arrays.
+ *
+ * The messages are sent exactly as for `bulk::queue`, but each component of
+ * the received messages is stored contiguously in its own column. Loops that
+ * only read some of the components (e.g. filter on a tag) then only touch
+ * the memory of those components.
+ *
+ * \tparam Ts the types of the components of a message
+ */
+template <typename... Ts>
+class soa_queue {
+ public:
+  /** The type of the `I`-th component of a message. */
+  template <size_t I>
+  using value_type =
+      typename representation<std::tuple_element_t<I, std::tuple<Ts...>>>::type;
+
+  /**
+   * An object providing syntactic sugar for sending messages:
+   *
+   *     q(processor).send(content...);
+   */
+  class sender {
+   public:
+    /** Send a message over the queue. */
+    void send(const typename representation<Ts>::type&... args) {
+      q_.impl_->send_(t_, args...);
+    }
+
+   private:
+    friend soa_queue;
+
+    sender(soa_queue& q, int t) : q_(q), t_(t) {}
+
+    soa_queue& q_;
+    int t_;
+  };
+
+  /**
+   * Construct a message queue and register it with world
+   * The world implementation can choose to perform a synchronization
+   */
+  soa_queue(bulk::world& world) { impl_ = std::make_unique<impl>(world); }
+
+  // Disallow copies
+  soa_queue(soa_queue& other) = delete;
+  void operator=(soa_queue& other) = delete;
+
+  /**
+   * Move a queue.
+   */
+  soa_queue(soa_queue&& other) { impl_ = std::move(other.impl_); }
+
+  /**
+   * Move a queue.
+   */
+  void operator=(soa_queue&& other) { impl_ = std::move(other.impl_); }
+
+  /**
+   * Get an object with which you can send to a remote queue
+   */
+  auto operator()(int t) { return sender(*this, t); }
+
+  /**
+   * Get the `I`-th component of every message in the local queue.
+   *
+   * The `i`-th element of each column belongs to the `i`-th message.
+   */
+  template <size_t I>
+  std::span<value_type<I>> column() {
+    return std::get<I>(impl_->columns_);
+  }
+
+  /**
+   * Get the number of messages in the local queue.
+   */
+  size_t size() { return std::get<0>(impl_->columns_).size(); }
+
+  /**
+   * Check if the queue is empty.
+   */
+  bool empty() { return size() == 0; }
+
+  /**
+   * Clear the messages in the queue.
+   */
+  void clear() { impl_->clear_(); }
+
+  /**
+   * Get a reference to the world of the queue.
+   *
+   * \returns a reference to the world of the queue
+   */
+  bulk::world& world() { return impl_->world_; }
+
+ private:
+  class impl : public queue_base {
+   public:
+    impl(bulk::world& world) : world_(world) {
+      id_ = world.register_queue_(this);
+    }
+    ~impl() { world_.unregister_queue_(id_); }
+
+    // No copies or moves
+    impl(impl& other) = delete;
+    impl(impl&& other) = delete;
+    void operator=(impl& other) = delete;
+    void operator=(impl&& other) = delete;
+
+    void send_(int t, const typename representation<Ts>::type&... args) {
+      auto size = bulk::detail::serialized_size(args...);
+      auto target_buffer = world_.send_buffer_(t, id_, size);
+      auto membuf = bulk::detail::memory_buffer_base(target_buffer);
+      auto ibuf = bulk::detail::imembuf(membuf);
+      bulk::detail::fill(ibuf, args...);
+    }
+
+    // Each component is deserialized directly into its column
+    void deserialize_push(size_t, char* data) override {
+      auto membuf = bulk::detail::memory_buffer_base(data);
+      std::apply(
+          [&](auto&... columns) { ((membuf >> columns.emplace_back()), ...); },
+          columns_);
+    }
+
+    void clear_() override {
+      std::apply([](auto&... columns) { (columns.clear(), ...); }, columns_);
+    }
+
+    std::tuple<std::vector<typename representation<Ts>::type>...> columns_;
+    bulk::world& world_;
+    int id_;
+  };
+  std::unique_ptr<impl> impl_;
+
+  friend sender;
+};
+
+/**
+ * A queue for key-value messages, that combines the values of messages with
+ * equal keys.
+ *
+ * Messages are not sent immediately, but combined per destination in a hash
+ * table. At the next `sync`, all combined messages for a destination are sent
+ * at once, and combined again on receipt. This way, only one message per
+ * distinct key is communicated and stored, which is a large saving if e.g.
+ * counts for the same key are sent many times (as in a word count).
+ *
+ * \tparam Key the type of the keys
+ * \tparam Value the type of the values
+ * \tparam Combine the function used to combine the values of two messages
+ * with the same key, either `(Value&, Value) -> void` or a binary operator.
+ */
+template <typename Key, typename Value, typename Combine = std::plus<Value>>
+class combining_queue {
+ public:
+  using message_type = std::pair<Key, Value>;
+  using iterator = typename util::flat_map<Key, Value>::iterator;
+
+  /**
+   * An object providing syntactic sugar for sending messages:
+   *
+   *     q(processor).send(key, value);
+   */
+  class sender {
+   public:
+    /** Send a message over the queue, combining it with earlier messages. */
+    void send(const Key& key, Value value) {
+      q_.impl_->outgoing_[t_].combine(key, value, q_.impl_->combine_);
+    }
+
+   private:
+    friend combining_queue;
+
+    sender(combining_queue& q, int t) : q_(q), t_(t) {}
+
+    combining_queue& q_;
+    int t_;
+  };
+
+  /**
+   * Construct a combining queue and register it with world
+   * The world implementation can choose to perform a synchronization
+   */
+  combining_queue(bulk::world& world, Combine combine = {}) {
+    impl_ = std::make_unique<impl>(world, combine);
+  }
+
+  // Disallow copies
+  combining_queue(combining_queue& other) = delete;
+  void operator=(combining_queue& other) = delete;
+
+  /**
+   * Move a queue.
+   */
+  combining_queue(combining_queue&& other) { impl_ = std::move(other.impl_); }
+
+  /**
+   * Move a queue.
+   */
+  void operator=(combining_queue&& other) { impl_ = std::move(other.impl_); }
+
+  /**
+   * Get an object with which you can send to a remote queue
+   */
+  auto operator()(int t) { return sender(*this, t); }
+
+  /**
+   * Get an iterator to the begin of the local queue, which holds a
+   * `std::pair<Key, Value>` for each distinct key
+   */
+  iterator begin() { return impl_->received_.begin(); }
+
+  /**
+   * Get an iterator to the end of the local queue
+   */
+  iterator end() { return impl_->received_.end(); }
+
+  /**
+   * Get the number of (distinct) messages in the local queue.
+   */
+  size_t size() { return impl_->received_.size(); }
+
+  /**
+   * Check if the queue is empty.
+   */
+  bool empty() { return impl_->received_.empty(); }
+
+  /**
+   * Clear the messages in the queue.
+   */
+  void clear() { impl_->clear_(); }
+
+  /**
+   * Get a reference to the world of the queue.
+   *
+   * \returns a reference to the world of the queue
+   */
+  bulk::world& world() { return impl_->world_; }
+
+ private:
+  static_assert(std::is_trivially_copyable_v<Value>,
+                "combining_queue only supports trivially-copyable values");
+
+  class impl : public queue_base {
+   public:
+    impl(bulk::world& world, Combine combine)
+        : outgoing_(world.active_processors()),
+          combine_(combine),
+          world_(world) {
+      id_ = world.register_queue_(this);
+    }
+    ~impl() { world_.unregister_queue_(id_); }
+
+    // No copies or moves
+    impl(impl& other) = delete;
+    impl(impl&& other) = delete;
+    void operator=(impl& other) = delete;
+    void operator=(impl&& other) = delete;
+
+    // All combined messages for a destination are sent as a single message
+    void flush_() override {
+      for (int t = 0; t < world_.active_processors(); ++t) {
+        auto& entries = outgoing_[t];
+        if (entries.empty()) {
+          continue;
+        }
+
+        auto size = bulk::detail::serialized_size(entries.size());
+        for (auto& [key, value] : entries) {
+          size += bulk::detail::serialized_size(key, value);
+        }
+
+        auto target_buffer = world_.send_buffer_(t, id_, size);
+        auto membuf = bulk::detail::memory_buffer_base(target_buffer);
+        auto ibuf = bulk::detail::imembuf(membuf);
+        membuf << entries.size();
+        for (auto& [key, value] : entries) {
+          bulk::detail::fill(ibuf, key, value);
+        }
+        entries.clear();
+      }
+    }
+
+    void deserialize_push(size_t, char* data) override {
+      auto membuf = bulk::detail::memory_buffer_base(data);
+      auto obuf = bulk::detail::omembuf(membuf);
+      size_t count = 0;
+      membuf >> count;
+      auto key = Key{};
+      auto value = Value{};
+      for (size_t i = 0; i < count; ++i) {
+        bulk::detail::fill(obuf, key, value);
+        received_.combine(key, value, combine_);
+      }
+    }
+
+    void clear_() override { received_.clear(); }
+
+    std::vector<util::flat_map<Key, Value>> outgoing_;
+    util::flat_map<Key, Value> received_;
+    Combine combine_;
     bulk::world& world_;
     int id_;
   };
@@ -1,58 +1,100 @@
-/**
- * A partitioned array is a co-array with a special structure. Locally it
- * behaves like a nD array, indexable using `local`. It also knows about the
- * global structure through its associated partitioning.
- * - The data is stored linearly.
- * - A partitioning is defined in a general way, and contains functions for
- * owner and local index lookup, as well as flattening of multi-indices.
- * - convenient indexing features
- *
- * Examples of partitionings include:
- * - Block partitioning
- * - Cyclic partitioning
- * - A binary tree of splits, giving a binary (space) partitioning.
- * - A set of slices ((2,2,1,1), (3,2,1)), see
- * http://dask.pydata.org/en/latest/array-creation.html
- * - Custom partitionings, for example cartesian distributions using different
- * functions for each axis
- *
- * Some design decisions that have to be made have to do with inheritence and
- * overload functions.
- *
- * Also, we want to support multi-indices, but dont want to resort to `arrays`
- * for everything. Using parameter packs we can do this nicely for the user, but
- * internally we still resort to arrays. This leads to duplicated
- * implementations in the partitioning objects and should be fixed.
- *
- * As it is, this is probably over-engineered and will see major revisions.
- */
+#pragma once
 
 #include <array>
+#include <cstddef>
+#include <vector>
 
 #include "coarray.hpp"
 #include "future.hpp"
+#include "local_view.hpp"
 #include "partitionings/partitioning.hpp"
+#include "util/indices.hpp"
+#include "world.hpp"
+
+/**
+ * \file partitioned_array.hpp
+ *
+ * This header provides a distributed multi-dimensional array, whose elements
+ * are distributed over the processors according to a partitioning.
+ */
 
 namespace bulk {
 
+namespace detail {
+
 /**
- * A partitioned array is a distributed array with an associated partitioning.
+ * Compute the global index along each axis of the local elements of
+ * `processor`, for partitionings where these are determined axis by axis,
+ * i.e. cartesian and rectangular partitionings.
+ *
+ * \returns whether the partitioning is of this kind
+ */
+template <int D, int G>
+bool local_globals(multi_partitioning<D, G>& part, index_type<G> processor,
+                   std::array<std::vector<size_t>, D>& globals) {
+  auto cartesian = dynamic_cast<cartesian_partitioning<D, G>*>(&part);
+  auto rectangular = dynamic_cast<rectangular_partitioning<D, G>*>(&part);
+  if (!cartesian && !rectangular) {
+    return false;
+  }
+  auto size = part.local_size(processor);
+  auto origin = rectangular ? rectangular->origin(processor) : index_type<D>{};
+  for (int d = 0; d < D; ++d) {
+    globals[d].resize(size[d]);
+    for (size_t i = 0; i < size[d]; ++i) {
+      if (rectangular) {
+        globals[d][i] = origin[d] + i;
+      } else {
+        globals[d][i] = d < G ? cartesian->global(d, processor[d], i) : i;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace detail
+
+/**
+ * A partitioned array is a distributed `D`-dimensional array with an
+ * associated partitioning over a `G`-dimensional processor grid.
+ *
+ * The local elements are stored contiguously in a coarray, flattened as by
+ * `bulk::util::flatten`. The local extents and strides are computed once, so
+ * that local indexing is a non-virtual dot product with the strides. For
+ * cartesian and rectangular partitionings, the global index along each axis
+ * of the local elements is cached as well, so that iterating over the local
+ * elements with their global indices does not call into the partitioning.
  *
- * It is used to retain the notion of a 'global index' without refering
- * specifically to a partitioning.
+ * Elements can also be accessed with a global index, which requires the owner
+ * and local index computations of the partitioning.
  *
- * TODO: think about template argument storage class (coarray by default)
- * TODO: this about specializing for 'rectangular partitionings'
+ *     auto part = bulk::block_partitioning<2>({100, 100}, {2, 2});
+ *     auto xs = bulk::partitioned_array<double, 2>(world, part);
+ *     xs.for_each([](auto index, auto& x) { x = index[0] + index[1]; });
+ *     auto corner = xs.global({99, 99}).get();
+ *     world.sync();
  */
-template <typename T, int D, int G>
+template <typename T, int D, int G = D>
 class partitioned_array {
  public:
-  /** Construct a partitioned array from a given partitioning. */
-  partitioned_array(bulk::world& world, multi_partitioning<D, G>& part)
+  /**
+   * Construct a partitioned array from a given partitioning, with all local
+   * elements set to `value`. The partitioning has to outlive the array.
+   */
+  partitioned_array(bulk::world& world, multi_partitioning<D, G>& part,
+                    T value = {})
       : world_(world),
         partitioning_(part),
-        data_(world, partitioning_.local_count(world.rank())) {
-    multi_id_ = util::unflatten<D>(partitioning_.grid(), world.rank());
+        multi_id_(part.multi_rank(world.rank())),
+        local_size_(part.local_size(multi_id_)),
+        data_(world, count_(local_size_), value) {
+    size_t stride = 1;
+    for (int d = 0; d < D; ++d) {
+      strides_[d] = stride;
+      stride *= local_size_[d];
+    }
+    separable_ =
+        detail::local_globals<D, G>(partitioning_, multi_id_, globals_);
   }
 
   /** Get an image to a (possibly remote) element using a global index. */
@@ -64,20 +106,102 @@ class partitioned_array {
   }
 
   /** Get an element using its local index. */
-  T& local(index_type<D> index) {
-    return data_[util::flatten<D>(partitioning_.local_size(multi_id_), index)];
-  }
+  T& local(index_type<D> index) { return data_[flatten_(index)]; }
 
   /// ditto
-  const T& local(index_type<D> index) const {
-    return data_[util::flatten<D>(partitioning_.local_size(multi_id_), index)];
+  const T& local(index_type<D> index) const { return data_[flatten_(index)]; }
+
+  /** Get the global index of the local element with local index `index`. */
+  index_type<D> global_index(index_type<D> index) const {
+    if (!separable_) {
+      return partitioning_.global(index, multi_id_);
+    }
+    for (int d = 0; d < D; ++d) {
+      index[d] = globals_[d][index[d]];
+    }
+    return index;
   }
 
+  /**
+   * Call `f(index, x)` for each local element `x`, with `index` its global
+   * index, in the order in which the elements are stored.
+   */
+  template <typename Func>
+  void for_each(Func f) {
+    auto count = size();
+    if (count == 0) {
+      return;
+    }
+    auto local_idx = index_type<D>{};
+    auto global_idx = global_index(local_idx);
+    for (size_t k = 0; k < count; ++k) {
+      f(global_idx, data_[k]);
+      // Advance the local index, with the first axis fastest
+      for (int d = 0; d < D; ++d) {
+        if (++local_idx[d] < local_size_[d]) {
+          break;
+        }
+        local_idx[d] = 0;
+      }
+      if (separable_) {
+        for (int d = 0; d < D; ++d) {
+          global_idx[d] = globals_[d][local_idx[d]];
+        }
+      } else {
+        global_idx = partitioning_.global(local_idx, multi_id_);
+      }
+    }
+  }
+
+  /**
+   * A view of the local elements, indexed by their local indices, e.g. for
+   * inner loops that should compile to plain pointer arithmetic.
+   */
+  bulk::local_view<T, D> view() { return {data(), local_size_}; }
+
+  /** The number of local elements along each axis. */
+  index_type<D> local_size() const { return local_size_; }
+
+  /** The distance between consecutive local elements along each axis. */
+  index_type<D> strides() const { return strides_; }
+
+  /** The number of local elements. */
+  size_t size() const { return data_.size(); }
+
+  /** The local elements, stored contiguously. */
+  T* data() { return data_.data(); }
+  const T* data() const { return data_.data(); }
+
+  T* begin() { return data_.begin(); }
+  T* end() { return data_.end(); }
+  const T* begin() const { return data_.begin(); }
+  const T* end() const { return data_.end(); }
+
   /** Get a reference to the world of the array. */
-  auto world() const { return world_; }
+  bulk::world& world() const { return world_; }
+
+  /** Get a reference to the partitioning of the array. */
+  multi_partitioning<D, G>& partitioning() const { return partitioning_; }
+
+  /** Get the coarray that holds the local elements. */
+  bulk::coarray<T>& storage() { return data_; }
 
  private:
-  index<D> multi_id_;
+  static size_t count_(index_type<D> size) {
+    size_t result = 1;
+    for (int d = 0; d < D; ++d) {
+      result *= size[d];
+    }
+    return result;
+  }
+
+  size_t flatten_(index_type<D> index) const {
+    size_t result = 0;
+    for (int d = 0; d < D; ++d) {
+      result += index[d] * strides_[d];
+    }
+    return result;
+  }
 
   // world in which this array resides
   bulk::world& world_;
@@ -85,6 +209,18 @@ class partitioned_array {
   // underlying partitioning
   multi_partitioning<D, G>& partitioning_;
 
+  // the index of the local processor in the processor grid
+  index_type<G> multi_id_;
+
+  // the local extents, and the strides of the local storage
+  index_type<D> local_size_;
+  index_type<D> strides_;
+
+  // the global index along each axis of the local elements, if the
+  // partitioning is separable
+  bool separable_ = false;
+  std::array<std::vector<size_t>, D> globals_;
+
   // linear storage
   bulk::coarray<T> data_;
 };
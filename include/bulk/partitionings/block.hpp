@@ -1,3 +1,5 @@
+#pragma once
+
 #include "partitioning.hpp"
 
 namespace bulk {
@@ -45,9 +47,9 @@ class block_partitioning : public rectangular_partitioning<D, G> {
 
   /** Compute the local indices of a element using its global indices */
   index_type<D> local(index_type<D> index) override final {
-    auto t = this->owner(index);
+    auto first = origin(multi_owner(index));
     for (int d = 0; d < D; ++d) {
-      index[d] = index[d] - this->origin(t)[d];
+      index[d] = index[d] - first[d];
     }
     return index;
   }
@@ -89,6 +91,9 @@ class block_partitioning : public rectangular_partitioning<D, G> {
   /** Obtain the block size in each dimension. */
   index_type<D> block_size() const { return block_size_; }
 
+  /** Obtain the data axis that is partitioned along each grid axis. */
+  index_type<G> axes() const { return axes_; }
+
   /** Obtain the origin of the block of processor `multi_index'. */
   index_type<D> origin(index_type<G> multi_index) const override {
     index_type<D> result = {};
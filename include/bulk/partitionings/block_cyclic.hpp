@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include "partitioning.hpp"
+
+namespace bulk {
+
+/**
+ * A block-cyclic partitioning, as in ScaLAPACK. Along each of the first G
+ * axes, the indices are divided into blocks, and the blocks are distributed
+ * cyclically over the processors along the corresponding grid axis.
+ *
+ * With blocks of size one this is a cyclic partitioning, and with blocks that
+ * are as large as the global size divided by the grid size it is a block
+ * partitioning. Along axes where both the block size and the grid size are
+ * powers of two, the index computations use shifts and masks instead of
+ * divisions.
+ */
+template <int D, int G = D>
+class block_cyclic_partitioning : public cartesian_partitioning<D, G> {
+ public:
+  using cartesian_partitioning<D, G>::owner;
+  using cartesian_partitioning<D, G>::local;
+  using cartesian_partitioning<D, G>::global;
+  using cartesian_partitioning<D, G>::local_size;
+
+  /**
+   * Constructs a block-cyclic partitioning in nD.
+   *
+   * `data_size`: the global number of elements along each axis
+   * `grid`: the number of processors in each dimension
+   * `block_size`: the number of consecutive elements in a block, along each
+   * of the first `G` axes
+   */
+  block_cyclic_partitioning(index_type<D> data_size, index_type<G> grid,
+                            index_type<G> block_size)
+      : cartesian_partitioning<D, G>(data_size, grid),
+        block_size_(block_size) {
+    static_assert(G <= D,
+                  "Dimensionality of the data should be larger or equal to "
+                  "that of the processor grid.");
+    for (int g = 0; g < G; ++g) {
+      pow2_[g] = std::has_single_bit(block_size_[g]) &&
+                 std::has_single_bit(this->grid_size_[g]);
+      block_shift_[g] = std::countr_zero(block_size_[g]);
+      cycle_shift_[g] = block_shift_[g] + std::countr_zero(this->grid_size_[g]);
+    }
+  }
+
+  /** Compute the local indices of a element using its global indices */
+  index_type<D> local(index_type<D> index) override final {
+    for (int g = 0; g < G; ++g) {
+      index[g] = local(g, index[g]);
+    }
+    return index;
+  }
+
+  /** Local to global */
+  index_type<D> global(index_type<D> xs,
+                       index_type<G> processor) override final {
+    for (int g = 0; g < G; ++g) {
+      xs[g] = global(g, processor[g], xs[g]);
+    }
+    return xs;
+  }
+
+  /** The total number of elements along each axis on the processor index with
+   * `idxs...` */
+  index_type<D> local_size(index_type<G> idxs) override final {
+    auto size = this->global_size_;
+    for (int g = 0; g < G; ++g) {
+      size[g] = local_size(g, idxs[g]);
+    }
+    return size;
+  }
+
+  /** Block-cyclic in first 'G' dimensions. */
+  index_type<G> multi_owner(index_type<D> xs) override final {
+    index_type<G> result = {};
+    for (int g = 0; g < G; ++g) {
+      result[g] = owner(g, xs[g]);
+    }
+    return result;
+  }
+
+  int owner(int g, size_t i) override final {
+    if (pow2_[g]) {
+      return (i >> block_shift_[g]) & (this->grid_size_[g] - 1);
+    }
+    return (i / block_size_[g]) % this->grid_size_[g];
+  }
+
+  size_t local(int g, size_t i) override final {
+    auto b = block_size_[g];
+    if (pow2_[g]) {
+      return ((i >> cycle_shift_[g]) << block_shift_[g]) | (i & (b - 1));
+    }
+    return (i / (b * this->grid_size_[g])) * b + i % b;
+  }
+
+  size_t global(int g, int u, size_t i) override final {
+    auto b = block_size_[g];
+    if (pow2_[g]) {
+      return ((i >> block_shift_[g]) << cycle_shift_[g]) |
+             (static_cast<size_t>(u) << block_shift_[g]) | (i & (b - 1));
+    }
+    return (i / b) * b * this->grid_size_[g] + u * b + i % b;
+  }
+
+  size_t local_size(int g, int u) override final {
+    if (g >= G) {
+      return this->global_size_[g];
+    }
+    // the complete cycles of blocks, and what remains in the last cycle
+    auto b = block_size_[g];
+    auto cycle = b * this->grid_size_[g];
+    auto cycles = this->global_size_[g] / cycle;
+    auto rest = this->global_size_[g] - cycles * cycle;
+    auto first = u * b;
+    return cycles * b + (rest > first ? std::min(rest - first, b) : 0);
+  }
+
+  /** Obtain the block size along each of the first `G` axes. */
+  index_type<G> block_size() const { return block_size_; }
+
+ private:
+  index_type<G> block_size_;
+  // whether the block size and the grid size are powers of two
+  std::array<bool, G> pow2_ = {};
+  std::array<int, G> block_shift_ = {};
+  std::array<int, G> cycle_shift_ = {};
+};
+
+}  // namespace bulk
@@ -0,0 +1,370 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "../algorithm.hpp"
+#include "../partitioned_array.hpp"
+#include "../world.hpp"
+#include "tree.hpp"
+
+/**
+ * \file rcb.hpp
+ *
+ * This header provides recursive coordinate bisection (RCB), which constructs
+ * a tree partitioning that balances weights distributed over the processors.
+ */
+
+namespace bulk {
+
+namespace detail {
+
+// The number of buckets of the histograms from which a weighted median is
+// selected. Each round narrows the candidate splits by this factor.
+constexpr size_t rcb_buckets = 64;
+
+using split_node = util::binary_tree<util::split>::node;
+
+// The number of leaves below `node`, where a missing child is a leaf
+inline int rcb_leaves_(const split_node* node) {
+  if (!node) {
+    return 1;
+  }
+  return rcb_leaves_(node->left.get()) + rcb_leaves_(node->right.get());
+}
+
+// A box of the bisection that is divided over more than one processor
+template <int D>
+struct rcb_box {
+  index_type<D> lower;
+  index_type<D> upper;
+  int procs;
+  // the total weight in the box
+  double weight;
+  // the node to which the split of this box is attached
+  split_node* parent;
+  util::binary_tree<util::split>::dir direction;
+  // the corresponding node of a previous bisection, or `nullptr`
+  const split_node* hint;
+
+  // The state of the selection: the split is `c` or `c - 1` for some `c` in
+  // `[lo, hi]`, and `below` is the weight with `x[axis] < lo`.
+  int axis = 0;
+  size_t lo = 0;
+  size_t hi = 0;
+  double below = 0.0;
+  double target = 0.0;
+  bool done = false;
+  size_t split = 0;
+  double left_weight = 0.0;
+};
+
+// Choose the split of `box` between the candidates `c - 1` and `c`, with
+// `weight` the weight with `x[axis] == c`.
+template <int D>
+void rcb_choose_(rcb_box<D>& box, size_t c, double weight) {
+  auto first = box.lower[box.axis];
+  auto last = box.upper[box.axis] - 2;
+  auto above = box.below + weight;
+  bool take_c =
+      std::abs(above - box.target) <= std::abs(box.below - box.target);
+  if (c == first || (take_c && c <= last)) {
+    box.split = c;
+    box.left_weight = above;
+  } else {
+    box.split = c - 1;
+    box.left_weight = box.below;
+  }
+  box.done = true;
+}
+
+// Bisect the boxes of one level of the tree, by selecting the weighted
+// median of each box with a distributed histogram search. `owner[i]` is the
+// box of point `i`, or -1.
+template <int D>
+void rcb_select_(bulk::world& world, std::vector<rcb_box<D>>& boxes,
+                 std::span<const index_type<D>> points,
+                 std::span<const double> weights,
+                 const std::vector<int>& owner) {
+  constexpr auto B = rcb_buckets;
+  for (auto& box : boxes) {
+    if (box.done) {
+      continue;
+    }
+    auto left = box.procs / 2;
+    for (int d = 0; d < D; ++d) {
+      if (box.upper[d] - box.lower[d] >
+          box.upper[box.axis] - box.lower[box.axis]) {
+        box.axis = d;
+      }
+    }
+    auto extent = box.upper[box.axis] - box.lower[box.axis];
+    assert(extent >= 2 && "RCB needs at least as many elements as processors");
+    box.lo = box.lower[box.axis];
+    box.hi = box.upper[box.axis] - 1;
+    box.below = 0.0;
+    box.target = box.weight * left / box.procs;
+    if (box.weight <= 0.0) {
+      // Without weight, split the volume among the processors
+      auto c = box.lower[box.axis] + (extent * left) / box.procs;
+      box.split = std::clamp(c, box.lo + 1, box.hi) - 1;
+      box.done = true;
+    }
+  }
+
+  auto hist = std::vector<double>(boxes.size() * B);
+  auto width = [](auto& box) { return (box.hi - box.lo + B) / B; };
+  while (std::any_of(boxes.begin(), boxes.end(),
+                     [](auto& box) { return !box.done; })) {
+    std::fill(hist.begin(), hist.end(), 0.0);
+    for (size_t i = 0; i < points.size(); ++i) {
+      if (owner[i] < 0) {
+        continue;
+      }
+      auto& box = boxes[owner[i]];
+      auto x = points[i][box.axis];
+      if (box.done || x < box.lo || x > box.hi) {
+        continue;
+      }
+      hist[owner[i] * B + (x - box.lo) / width(box)] += weights[i];
+    }
+    bulk::allreduce(world, std::span<double>(hist), std::plus<double>{});
+
+    for (size_t b = 0; b < boxes.size(); ++b) {
+      auto& box = boxes[b];
+      if (box.done) {
+        continue;
+      }
+      auto w = width(box);
+      auto count = (box.hi - box.lo) / w + 1;
+      for (size_t k = 0; k < count; ++k) {
+        auto weight = hist[b * B + k];
+        if (box.below + weight < box.target && k + 1 < count) {
+          box.below += weight;
+          continue;
+        }
+        box.lo += k * w;
+        box.hi = std::min(box.hi, box.lo + w - 1);
+        if (box.lo == box.hi) {
+          rcb_choose_(box, box.lo, weight);
+        }
+        break;
+      }
+    }
+  }
+}
+
+// Bisect the volume `size` recursively, reusing the splits of `previous`
+// where they are balanced within `tolerance`.
+template <int D>
+util::binary_tree<util::split> rcb_build_(bulk::world& world,
+                                          index_type<D> size, int procs,
+                                          std::span<const index_type<D>> points,
+                                          std::span<const double> weights,
+                                          const split_node* previous,
+                                          double tolerance) {
+  using dir = util::binary_tree<util::split>::dir;
+  assert(points.size() == weights.size());
+  auto tree = util::binary_tree<util::split>{};
+  auto total =
+      bulk::sum(world, std::accumulate(weights.begin(), weights.end(), 0.0));
+
+  auto boxes = std::vector<rcb_box<D>>{};
+  if (procs > 1) {
+    boxes.push_back({{}, size, procs, total, nullptr, dir::left, previous});
+  }
+  auto owner = std::vector<int>(points.size(), boxes.empty() ? -1 : 0);
+  while (!boxes.empty()) {
+    // Keep the previous splits that still balance the weights
+    auto usable = [](auto& box) {
+      auto h = box.hint;
+      return h && h->value.d >= 0 && h->value.d < D &&
+             h->value.a >= box.lower[h->value.d] &&
+             h->value.a + 1 < box.upper[h->value.d] &&
+             rcb_leaves_(h->left.get()) == box.procs / 2 &&
+             rcb_leaves_(h->right.get()) == box.procs - box.procs / 2;
+    };
+    auto hinted = std::vector<char>(boxes.size());
+    std::transform(boxes.begin(), boxes.end(), hinted.begin(), usable);
+    if (std::any_of(hinted.begin(), hinted.end(), [](auto h) { return h; })) {
+      auto left = std::vector<double>(boxes.size());
+      for (size_t i = 0; i < points.size(); ++i) {
+        if (owner[i] < 0 || !hinted[owner[i]]) {
+          continue;
+        }
+        auto s = boxes[owner[i]].hint->value;
+        if (points[i][s.d] <= s.a) {
+          left[owner[i]] += weights[i];
+        }
+      }
+      bulk::allreduce(world, std::span<double>(left), std::plus<double>{});
+      for (size_t b = 0; b < boxes.size(); ++b) {
+        auto& box = boxes[b];
+        if (!hinted[b]) {
+          box.hint = nullptr;
+          continue;
+        }
+        auto target = box.weight * (box.procs / 2) / box.procs;
+        if (std::abs(left[b] - target) <= tolerance * box.weight) {
+          box.axis = box.hint->value.d;
+          box.split = box.hint->value.a;
+          box.left_weight = left[b];
+          box.done = true;
+        } else {
+          box.hint = nullptr;
+        }
+      }
+    }
+
+    rcb_select_<D>(world, boxes, points, weights, owner);
+
+    // Attach the splits, and divide the boxes and their points
+    auto next = std::vector<rcb_box<D>>{};
+    auto children = std::vector<std::array<int, 2>>(boxes.size(), {-1, -1});
+    for (size_t b = 0; b < boxes.size(); ++b) {
+      auto& box = boxes[b];
+      auto node = tree.add(box.parent, box.direction,
+                           util::split{box.axis, box.split});
+      auto left = box.procs / 2;
+      auto right = box.procs - left;
+      auto left_upper = box.upper;
+      left_upper[box.axis] = box.split + 1;
+      auto right_lower = box.lower;
+      right_lower[box.axis] = box.split + 1;
+      auto hint = [&](dir direction) -> const split_node* {
+        if (!box.hint) {
+          return nullptr;
+        }
+        return (direction == dir::left ? box.hint->left : box.hint->right)
+            .get();
+      };
+      if (left > 1) {
+        children[b][0] = next.size();
+        next.push_back({box.lower, left_upper, left, box.left_weight, node,
+                        dir::left, hint(dir::left)});
+      }
+      if (right > 1) {
+        children[b][1] = next.size();
+        next.push_back({right_lower, box.upper, right,
+                        box.weight - box.left_weight, node, dir::right,
+                        hint(dir::right)});
+      }
+    }
+    for (size_t i = 0; i < points.size(); ++i) {
+      if (owner[i] < 0) {
+        continue;
+      }
+      auto& box = boxes[owner[i]];
+      owner[i] = children[owner[i]][points[i][box.axis] > box.split];
+    }
+    boxes = std::move(next);
+  }
+  return tree;
+}
+
+}  // namespace detail
+
+/**
+ * Construct a tree partitioning of a volume of shape `size` over all
+ * processors by weighted recursive coordinate bisection (RCB).
+ *
+ * Each box is split along its longest axis, such that the weight on each side
+ * is proportional to the number of processors it is divided over. The split
+ * is the weighted median, which is selected by refining a histogram of the
+ * weights along the axis, with one reduction for all boxes of a level of the
+ * tree per round. This takes `O(log p * log_64 n)` reductions, with `n` the
+ * longest extent of the volume. For a number of processors that is not a
+ * power of two, the tree is not perfect.
+ *
+ * \param world the world over which to partition
+ * \param size the global number of elements along each axis
+ * \param points the global indices of the local weights, e.g. the cells of
+ * the local particles, which need not be owned by this processor
+ * \param weights the weight of each point
+ */
+template <int D>
+tree_partitioning<D> rcb_partitioning(bulk::world& world, index_type<D> size,
+                                      std::span<const index_type<D>> points,
+                                      std::span<const double> weights) {
+  auto p = world.active_processors();
+  return tree_partitioning<D>(
+      size, p,
+      detail::rcb_build_<D>(world, size, p, points, weights, nullptr, 0.0));
+}
+
+/**
+ * Construct a tree partitioning by weighted RCB, with the weights of
+ * the cells of a partitioned array.
+ */
+template <int D, int G>
+tree_partitioning<D> rcb_partitioning(
+    bulk::partitioned_array<double, D, G>& weights) {
+  auto points = std::vector<index_type<D>>{};
+  points.reserve(weights.size());
+  weights.for_each([&](auto index, auto) { points.push_back(index); });
+  return rcb_partitioning<D>(weights.world(),
+                             weights.partitioning().global_size(), points,
+                             std::span<const double>(weights.data(),
+                                                     weights.size()));
+}
+
+/**
+ * Rebalance a partitioning obtained by RCB, after the weights have changed.
+ *
+ * The splits of `previous` are kept from the root downward, as long as the
+ * weight on the left of a split deviates at most `tolerance` times the weight
+ * of its box from the target. Boxes whose split is no longer balanced are
+ * bisected anew, as is everything below them. Processors whose subtree is
+ * kept keep their part of the volume, so that only the elements around
+ * the changed splits have to be moved, e.g. with `bulk::redistribute`.
+ *
+ * \param previous the partitioning to rebalance, over all processors
+ * \param tolerance the allowed relative deviation of a split
+ */
+template <int D>
+tree_partitioning<D> rcb_rebalance(bulk::world& world,
+                                   tree_partitioning<D>& previous,
+                                   std::span<const index_type<D>> points,
+                                   std::span<const double> weights,
+                                   double tolerance = 0.05) {
+  auto p = world.active_processors();
+  assert(previous.grid()[0] == static_cast<size_t>(p));
+  auto size = previous.global_size();
+  return tree_partitioning<D>(
+      size, p,
+      detail::rcb_build_<D>(world, size, p, points, weights,
+                            previous.splits().root.get(), tolerance));
+}
+
+/**
+ * The load imbalance of a partitioning: the largest total weight owned by a
+ * processor, divided by the average.
+ *
+ * \param points the global indices of the local weights
+ * \param weights the weight of each point
+ */
+template <int D>
+double load_imbalance(bulk::world& world, partitioning<D>& part,
+                      std::span<const index_type<D>> points,
+                      std::span<const double> weights) {
+  auto p = world.active_processors();
+  auto loads = std::vector<double>(p);
+  for (size_t i = 0; i < points.size(); ++i) {
+    loads[part.owner(points[i])] += weights[i];
+  }
+  bulk::allreduce(world, std::span<double>(loads), std::plus<double>{});
+  auto total = std::accumulate(loads.begin(), loads.end(), 0.0);
+  if (total <= 0.0) {
+    return 1.0;
+  }
+  return *std::max_element(loads.begin(), loads.end()) * p / total;
+}
+
+}  // namespace bulk
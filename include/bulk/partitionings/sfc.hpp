@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../util/search.hpp"
+#include "../util/sfc.hpp"
+#include "partitioning.hpp"
+
+namespace bulk {
+
+/** The space-filling curves supported by `sfc_partitioning`. */
+enum class sfc_curve { morton, hilbert };
+
+/**
+ * A partitioning along a space-filling curve.
+ *
+ * The elements are ordered along a Morton or Hilbert curve through the
+ * smallest cube with a power-of-two side that contains the volume, and each
+ * processor owns a contiguous range of this order. The owner of an index is
+ * found by a binary search of its key among the first keys of the
+ * processors. The parts are not rectangular, but (in particular for the
+ * Hilbert curve) they are compact, with a small surface.
+ *
+ * The local elements of a processor are stored in the order of the curve,
+ * i.e. the local size is `{count, 1, ..., 1}`, and the local index of an
+ * element is `{position, 0, ..., 0}`.
+ */
+template <int D>
+class sfc_partitioning : public multi_partitioning<D, 1> {
+ public:
+  using multi_partitioning<D, 1>::local_size;
+  using multi_partitioning<D, 1>::global;
+
+  /**
+   * Constructs a partitioning along a space-filling curve, that divides the
+   * elements equally over the processors.
+   *
+   * `data_size`: the global number of elements along each axis
+   * `procs`: the number of processors
+   * `curve`: the curve along which to order the elements
+   */
+  sfc_partitioning(index_type<D> data_size, int procs,
+                   sfc_curve curve = sfc_curve::hilbert)
+      : sfc_partitioning(data_size, curve, equal_(data_size, procs)) {}
+
+  /**
+   * Constructs a partitioning along a space-filling curve, with given ranges
+   * of the curve, e.g. to balance a workload.
+   *
+   * `data_size`: the global number of elements along each axis
+   * `curve`: the curve along which to order the elements
+   * `offsets`: a non-decreasing sequence of `procs + 1` positions along the
+   * curve, from `0` to the number of elements, where processor `t` owns the
+   * elements from `offsets[t]` up to `offsets[t + 1]`
+   */
+  sfc_partitioning(index_type<D> data_size, sfc_curve curve,
+                   std::vector<size_t> offsets)
+      : multi_partitioning<D, 1>(data_size, {offsets.size() - 1}),
+        curve_(curve),
+        offsets_(std::move(offsets)) {
+    size_t side = 1;
+    full_ = true;
+    for (int d = 0; d < D; ++d) {
+      while (side < data_size[d]) {
+        side *= 2;
+        ++bits_;
+      }
+    }
+    for (int d = 0; d < D; ++d) {
+      full_ = full_ && data_size[d] == side;
+    }
+    assert(D * bits_ <= 64 && "the keys of the curve have at most 64 bits");
+    assert(offsets_.front() == 0 && offsets_.back() == count_());
+
+    splitters_.resize(offsets_.size() - 1);
+    for (auto t = 0u; t < splitters_.size(); ++t) {
+      splitters_[t] =
+          offsets_[t] < offsets_.back() ? unrank_(offsets_[t]) : UINT64_MAX;
+    }
+  }
+
+  /** Compute the local indices of a element using its global indices */
+  index_type<D> local(index_type<D> index) override final {
+    auto k = key(index);
+    index_type<D> result = {};
+    result[0] = rank_(k) - offsets_[owner_(k)];
+    return result;
+  }
+
+  /** The total number of elements along each axis on the processor index with
+   * `idxs...` */
+  index_type<D> local_size(index_type<1> idxs) override final {
+    index_type<D> size = {};
+    for (int d = 0; d < D; ++d) {
+      size[d] = 1;
+    }
+    size[0] = offsets_[idxs.get() + 1] - offsets_[idxs.get()];
+    return size;
+  }
+
+  index_type<1> multi_owner(index_type<D> xs) override final {
+    return {static_cast<size_t>(owner_(key(xs)))};
+  }
+
+  index_type<D> global(index_type<D> xs, index_type<1> processor) override {
+    return cell(unrank_(offsets_[processor.get()] + xs[0]));
+  }
+
+  /**
+   * Get the owners of a batch of global indices.
+   *
+   * \param xs the global indices
+   * \param owners room for (at least) the owner of each index
+   * \returns the owners of the indices, i.e. the first `xs.size()` elements of
+   * `owners`
+   */
+  std::span<int> owner_batch(std::span<const index_type<D>> xs,
+                             std::span<int> owners) const {
+    assert(owners.size() >= xs.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+      owners[i] = owner_(key(xs[i]));
+    }
+    return owners.first(xs.size());
+  }
+
+  /** The key of the global index `xs` along the curve. */
+  std::uint64_t key(index_type<D> xs) const {
+    if (curve_ == sfc_curve::morton) {
+      return util::morton_encode<D>(xs);
+    }
+    return util::hilbert_encode<D>(xs, bits_);
+  }
+
+  /** The global index with key `key` along the curve. */
+  index_type<D> cell(std::uint64_t key) const {
+    if (curve_ == sfc_curve::morton) {
+      return util::morton_decode<D>(key);
+    }
+    return util::hilbert_decode<D>(key, bits_);
+  }
+
+  /** The curve along which the elements are ordered. */
+  sfc_curve curve() const { return curve_; }
+
+  /** The key of the first element of each processor. */
+  const std::vector<std::uint64_t>& splitters() const { return splitters_; }
+
+ private:
+  size_t count_() const {
+    size_t result = 1;
+    for (int d = 0; d < D; ++d) {
+      result *= this->global_size_[d];
+    }
+    return result;
+  }
+
+  static std::vector<size_t> equal_(index_type<D> data_size, int procs) {
+    size_t count = 1;
+    for (int d = 0; d < D; ++d) {
+      count *= data_size[d];
+    }
+    auto offsets = std::vector<size_t>(procs + 1);
+    for (int t = 0; t <= procs; ++t) {
+      offsets[t] = count * t / procs;
+    }
+    return offsets;
+  }
+
+  // The last processor whose first key is at most `key`
+  int owner_(std::uint64_t key) const {
+    auto count = util::upper_bound_index<std::uint64_t>(splitters_, key);
+    return static_cast<int>(count) - 1;
+  }
+
+  // The number of elements of the volume in the cube of the keys that share
+  // the `D * level` most significant bits of `key`
+  size_t overlap_(std::uint64_t key, int level) const {
+    auto side = size_t{1} << (bits_ - level);
+    auto first = cell(key);
+    size_t result = 1;
+    for (int d = 0; d < D; ++d) {
+      auto lower = first[d] & ~(side - 1);
+      auto upper = std::min(lower + side, this->global_size_[d]);
+      result *= upper > lower ? upper - lower : 0;
+    }
+    return result;
+  }
+
+  // The position along the curve of the element with key `key`, i.e. the
+  // number of elements of the volume with a smaller key. The subcubes that
+  // come first on each level are counted, until the subcube of `key` lies
+  // inside the volume.
+  size_t rank_(std::uint64_t key) const {
+    if (full_) {
+      return key;
+    }
+    size_t result = 0;
+    std::uint64_t prefix = 0;
+    for (int level = 1; level <= bits_; ++level) {
+      auto shift = D * (bits_ - level);
+      auto digit = (key >> shift) & ((std::uint64_t{1} << D) - 1);
+      for (std::uint64_t c = 0; c < digit; ++c) {
+        result += overlap_(((prefix << D) | c) << shift, level);
+      }
+      prefix = (prefix << D) | digit;
+      auto rest = key & ((std::uint64_t{1} << shift) - 1);
+      if (overlap_(key, level) == std::uint64_t{1} << shift) {
+        return result + rest;
+      }
+    }
+    return result;
+  }
+
+  // The key of the element at position `position` along the curve
+  std::uint64_t unrank_(size_t position) const {
+    if (full_) {
+      return position;
+    }
+    std::uint64_t prefix = 0;
+    for (int level = 1; level <= bits_; ++level) {
+      auto shift = D * (bits_ - level);
+      for (std::uint64_t c = 0; c < (std::uint64_t{1} << D); ++c) {
+        auto first = ((prefix << D) | c) << shift;
+        auto count = overlap_(first, level);
+        if (position < count) {
+          prefix = (prefix << D) | c;
+          if (count == std::uint64_t{1} << shift) {
+            return first + position;
+          }
+          break;
+        }
+        position -= count;
+      }
+    }
+    return prefix;
+  }
+
+  sfc_curve curve_;
+  int bits_ = 0;
+  // whether the volume is a cube with a power-of-two side
+  bool full_ = false;
+  std::vector<size_t> offsets_;
+  std::vector<std::uint64_t> splitters_;
+};
+
+}  // namespace bulk
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <span>
+#include <vector>
+
+#include "../util/search.hpp"
+#include "partitioning.hpp"
+
+namespace bulk {
+
+/**
+ * A partitioning into explicit slices along each axis, as the chunks of a
+ * dask array. Axis `d` is cut at a sorted list of boundaries, which need not
+ * be equally spaced, and the part of processor `t` is the product of the
+ * slices `t[d]` of each axis.
+ *
+ * For example, the chunks `((2, 2, 1, 1), (3, 2, 1))` of a 6 x 6 array have
+ * the boundaries `{0, 2, 4, 5, 6}` and `{0, 3, 5, 6}`, over a 4 x 3 grid.
+ *
+ * The owner along each axis is found by a binary search without branches
+ * among the boundaries, and the local index is the offset from the
+ * boundary at which the slice starts.
+ */
+template <int D>
+class slices_partitioning : public rectangular_partitioning<D, D> {
+ public:
+  using rectangular_partitioning<D, D>::local_size;
+  using rectangular_partitioning<D, D>::origin;
+  using rectangular_partitioning<D, D>::global;
+
+  /**
+   * Constructs a partitioning into slices in nD.
+   *
+   * `boundaries`: for each axis, the increasing sequence of indices at which
+   * the slices start, followed by the global number of elements along that
+   * axis. The first boundary of each axis is zero.
+   */
+  slices_partitioning(std::array<std::vector<size_t>, D> boundaries)
+      : rectangular_partitioning<D, D>(size_(boundaries), grid_(boundaries)),
+        boundaries_(std::move(boundaries)) {
+    for (int d = 0; d < D; ++d) {
+      assert(boundaries_[d].front() == 0);
+      assert(std::is_sorted(boundaries_[d].begin(), boundaries_[d].end()));
+    }
+  }
+
+  /** Compute the local indices of a element using its global indices */
+  index_type<D> local(index_type<D> index) override final {
+    for (int d = 0; d < D; ++d) {
+      index[d] -= boundaries_[d][slice(d, index[d])];
+    }
+    return index;
+  }
+
+  /** The total number of elements along each axis on the processor index with
+   * `idxs...` */
+  index_type<D> local_size(index_type<D> idxs) override final {
+    index_type<D> size = {};
+    for (int d = 0; d < D; ++d) {
+      size[d] = boundaries_[d][idxs[d] + 1] - boundaries_[d][idxs[d]];
+    }
+    return size;
+  }
+
+  index_type<D> multi_owner(index_type<D> xs) override final {
+    for (int d = 0; d < D; ++d) {
+      xs[d] = slice(d, xs[d]);
+    }
+    return xs;
+  }
+
+  index_type<D> origin(index_type<D> multi_index) const override {
+    for (int d = 0; d < D; ++d) {
+      multi_index[d] = boundaries_[d][multi_index[d]];
+    }
+    return multi_index;
+  }
+
+  /** The slice along axis `d` that contains the index `x`. */
+  size_t slice(int d, size_t x) const {
+    // the last boundary is the global size, which is larger than `x`
+    auto first = std::span<const size_t>(boundaries_[d]).first(
+        boundaries_[d].size() - 1);
+    return util::upper_bound_index(first, x) - 1;
+  }
+
+  /**
+   * Get the owners of a batch of global indices.
+   *
+   * The searches along each axis are done for all indices at once, so that
+   * the searches for different indices overlap.
+   *
+   * \param xs the global indices
+   * \param owners room for (at least) the owner of each index
+   * \returns the owners of the indices, i.e. the first `xs.size()` elements of
+   * `owners`
+   */
+  std::span<int> owner_batch(std::span<const index_type<D>> xs,
+                             std::span<int> owners) const {
+    assert(owners.size() >= xs.size());
+    std::fill(owners.begin(), owners.begin() + xs.size(), 0);
+    size_t stride = 1;
+    for (int d = 0; d < D; ++d) {
+      for (size_t i = 0; i < xs.size(); ++i) {
+        owners[i] += static_cast<int>(slice(d, xs[i][d]) * stride);
+      }
+      stride *= boundaries_[d].size() - 1;
+    }
+    return owners.first(xs.size());
+  }
+
+  /** The boundaries of the slices along axis `d`. */
+  const std::vector<size_t>& boundaries(int d) const { return boundaries_[d]; }
+
+ private:
+  static index_type<D> size_(
+      const std::array<std::vector<size_t>, D>& boundaries) {
+    index_type<D> result = {};
+    for (int d = 0; d < D; ++d) {
+      result[d] = boundaries[d].back();
+    }
+    return result;
+  }
+
+  static index_type<D> grid_(
+      const std::array<std::vector<size_t>, D>& boundaries) {
+    index_type<D> result = {};
+    for (int d = 0; d < D; ++d) {
+      assert(boundaries[d].size() >= 2);
+      result[d] = boundaries[d].size() - 1;
+    }
+    return result;
+  }
+
+  std::array<std::vector<size_t>, D> boundaries_;
+};
+
+}  // namespace bulk
@@ -0,0 +1,448 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <span>
+
+#include "../util/binary_tree.hpp"
+#include "../util/divider.hpp"
+#include "../util/indices.hpp"
+#include "../util/split_tree.hpp"
+
+/**
+ * \file static.hpp
+ *
+ * This header provides static variants of the block, cyclic and tree
+ * partitionings, whose index computations are not virtual and can be inlined,
+ * together with batched owner lookups.
+ */
+
+namespace bulk {
+
+/**
+ * A partitioning whose index computations are known at compile time, such as
+ * the static block, cyclic and tree partitionings.
+ */
+template <typename P>
+concept static_partitioning =
+    requires(const P& part, index_type<P::dimension> xs, int t,
+             std::span<const index_type<P::dimension>> batch,
+             std::span<int> owners) {
+      { part.owner(xs) } -> std::convertible_to<int>;
+      { part.local(xs) } -> std::same_as<index_type<P::dimension>>;
+      { part.global(xs, t) } -> std::same_as<index_type<P::dimension>>;
+      { part.local_size(t) } -> std::same_as<index_type<P::dimension>>;
+      { part.owner_batch(batch, owners) } -> std::same_as<std::span<int>>;
+    };
+
+/**
+ * Base class for static partitionings over a `G`-dimensional processor grid.
+ *
+ * The derived class `Derived` implements `owner_<Narrow>(xs)`, which computes
+ * the (flattened) owner of a global index directly, without going through a
+ * multi-index. If all global indices fit in 32 bits, `Narrow` is true, and
+ * divisions by the fixed sizes of the partitioning can use a
+ * `bulk::util::divider`.
+ */
+template <typename Derived, int D, int G>
+class static_partitioning_base {
+ public:
+  static constexpr int dimension = D;
+  static constexpr int grid_dimension = G;
+
+  static_partitioning_base(index_type<D> global_size, index_type<G> grid)
+      : global_size_(global_size), grid_(grid) {
+    size_t stride = 1;
+    for (int g = 0; g < G; ++g) {
+      grid_strides_[g] = stride;
+      stride *= grid_[g];
+    }
+    narrow_ = true;
+    for (int d = 0; d < D; ++d) {
+      narrow_ = narrow_ && global_size_[d] <= UINT32_MAX;
+    }
+  }
+
+  /** The global number of elements along each axis. */
+  index_type<D> global_size() const { return global_size_; }
+
+  /** The number of processors along each axis of the grid. */
+  index_type<G> grid() const { return grid_; }
+
+  /** Convert between rank and multi rank. */
+  int rank(index_type<G> t) const { return util::flatten<G>(grid_, t); }
+  index_type<G> multi_rank(int t) const {
+    return util::unflatten<G>(grid_, t);
+  }
+
+  /** The number of elements on processor `t`. */
+  size_t local_count(int t) const {
+    auto size = derived_().local_size(t);
+    size_t count = 1;
+    for (int d = 0; d < D; ++d) {
+      count *= size[d];
+    }
+    return count;
+  }
+
+  /** Get the owner of a global index. */
+  int owner(index_type<D> xs) const {
+    return narrow_ ? derived_().template owner_<true>(xs)
+                   : derived_().template owner_<false>(xs);
+  }
+
+  /**
+   * Get the owners of a batch of global indices.
+   *
+   * \param xs the global indices
+   * \param owners room for (at least) the owner of each index
+   * \returns the owners of the indices, i.e. the first `xs.size()` elements of
+   * `owners`
+   */
+  std::span<int> owner_batch(std::span<const index_type<D>> xs,
+                             std::span<int> owners) const {
+    assert(owners.size() >= xs.size());
+    // The loops are free of calls and hardware divisions, so that they can
+    // be vectorized
+    if (narrow_) {
+      for (size_t i = 0; i < xs.size(); ++i) {
+        owners[i] = derived_().template owner_<true>(xs[i]);
+      }
+    } else {
+      for (size_t i = 0; i < xs.size(); ++i) {
+        owners[i] = derived_().template owner_<false>(xs[i]);
+      }
+    }
+    return owners.first(xs.size());
+  }
+
+ protected:
+  // Divide `x` by `divisor`, for which `d` is a divider if `Narrow`
+  template <bool Narrow>
+  static size_t divide_(const util::divider& d, size_t divisor, size_t x) {
+    if constexpr (Narrow) {
+      return d.divide(static_cast<std::uint32_t>(x));
+    } else {
+      return x / divisor;
+    }
+  }
+
+  template <bool Narrow>
+  static size_t modulo_(const util::divider& d, size_t divisor, size_t x) {
+    if constexpr (Narrow) {
+      return d.modulo(static_cast<std::uint32_t>(x));
+    } else {
+      return x % divisor;
+    }
+  }
+
+  index_type<D> global_size_;
+  index_type<G> grid_;
+  std::array<size_t, G> grid_strides_ = {};
+  // whether all global indices fit in 32 bits
+  bool narrow_;
+
+ private:
+  const Derived& derived_() const { return static_cast<const Derived&>(*this); }
+};
+
+/**
+ * A static block partitioning, which equally block-distributes `G` axes of the
+ * data, as `bulk::block_partitioning`.
+ */
+template <int D, int G = D>
+class static_block_partitioning
+    : public static_partitioning_base<static_block_partitioning<D, G>, D, G> {
+  using base = static_partitioning_base<static_block_partitioning<D, G>, D, G>;
+  friend base;
+
+ public:
+  /**
+   * Constructs a block partitioning in nD.
+   *
+   * `data_size`: the global number of elements along each axis
+   * `grid`: the number of processors in each dimension
+   */
+  static_block_partitioning(index_type<D> data_size, index_type<G> grid)
+      : static_block_partitioning(data_size, grid, iota_()) {}
+
+  /**
+   * Constructs a block partitioning in nD.
+   *
+   * `data_size`: the global number of elements along each axis
+   * `grid`: the number of processors in each dimension
+   * `axes`: an array of size `G` that indicates the axes over which to
+   * partition
+   */
+  static_block_partitioning(index_type<D> data_size, index_type<G> grid,
+                            index_type<G> axes)
+      : base(data_size, grid), axes_(axes) {
+    static_assert(G <= D,
+                  "Dimensionality of the data should be larger or equal to "
+                  "that of the processor grid.");
+    for (int g = 0; g < G; ++g) {
+      auto n = data_size[axes_[g]];
+      auto P = grid[g];
+      auto k = (n - 1) / P + 1;
+      // The first `l` processors have `k` elements, the others `k - 1`
+      auto l = P - (k * P - n);
+      k_[g] = k;
+      l_[g] = l;
+      // The dividers only hold 32-bit divisors, and are only used for
+      // narrow indices
+      if (this->narrow_) {
+        div_k_[g] = util::divider(static_cast<std::uint32_t>(k));
+        div_k1_[g] =
+            util::divider(static_cast<std::uint32_t>(k > 1 ? k - 1 : 1));
+      }
+    }
+  }
+
+  /** The number of elements along each axis on processor `t`. */
+  index_type<D> local_size(index_type<G> t) const {
+    auto size = this->global_size_;
+    for (int g = 0; g < G; ++g) {
+      size[axes_[g]] = t[g] < l_[g] ? k_[g] : k_[g] - 1;
+    }
+    return size;
+  }
+  index_type<D> local_size(int t) const {
+    return local_size(this->multi_rank(t));
+  }
+
+  /** The global index of the first element of processor `t`. */
+  index_type<D> origin(index_type<G> t) const {
+    auto result = index_type<D>{};
+    for (int g = 0; g < G; ++g) {
+      result[axes_[g]] = axis_origin_(g, t[g]);
+    }
+    return result;
+  }
+  index_type<D> origin(int t) const { return origin(this->multi_rank(t)); }
+
+  /** Get the multi-dimensional owner of a global index. */
+  index_type<G> multi_owner(index_type<D> xs) const {
+    auto result = index_type<G>{};
+    for (int g = 0; g < G; ++g) {
+      result[g] = this->narrow_ ? axis_owner_<true>(g, xs[axes_[g]])
+                                : axis_owner_<false>(g, xs[axes_[g]]);
+    }
+    return result;
+  }
+
+  /** Convert a global index to a local index on its owner. */
+  index_type<D> local(index_type<D> xs) const {
+    for (int g = 0; g < G; ++g) {
+      auto d = axes_[g];
+      auto t = this->narrow_ ? axis_owner_<true>(g, xs[d])
+                             : axis_owner_<false>(g, xs[d]);
+      xs[d] -= axis_origin_(g, t);
+    }
+    return xs;
+  }
+
+  /** Convert a local index on processor `t` to a global index. */
+  index_type<D> global(index_type<D> xs, int t) const {
+    auto first = origin(t);
+    for (int d = 0; d < D; ++d) {
+      xs[d] += first[d];
+    }
+    return xs;
+  }
+
+  /** The data axis that is partitioned along each grid axis. */
+  index_type<G> axes() const { return axes_; }
+
+ private:
+  template <bool Narrow>
+  size_t axis_owner_(int g, size_t x) const {
+    auto kl = k_[g] * l_[g];
+    // If `k == 1`, all elements are in the first `l` blocks, and the result
+    // of the second division is unused, but it should not divide by zero
+    auto k1 = std::max<size_t>(k_[g] - 1, 1);
+    auto large = base::template divide_<Narrow>(div_k_[g], k_[g], x);
+    auto small = l_[g] + base::template divide_<Narrow>(div_k1_[g], k1, x - kl);
+    return x < kl ? large : small;
+  }
+
+  size_t axis_origin_(int g, size_t t) const {
+    return t <= l_[g] ? k_[g] * t : k_[g] * l_[g] + (t - l_[g]) * (k_[g] - 1);
+  }
+
+  template <bool Narrow>
+  int owner_(index_type<D> xs) const {
+    size_t t = 0;
+    for (int g = 0; g < G; ++g) {
+      t += axis_owner_<Narrow>(g, xs[axes_[g]]) * this->grid_strides_[g];
+    }
+    return static_cast<int>(t);
+  }
+
+  static index_type<G> iota_() {
+    index_type<G> result = {};
+    for (int i = 0; i < G; ++i) {
+      result[i] = i;
+    }
+    return result;
+  }
+
+  index_type<G> axes_;
+  std::array<size_t, G> k_ = {};
+  std::array<size_t, G> l_ = {};
+  std::array<util::divider, G> div_k_;
+  std::array<util::divider, G> div_k1_;
+};
+
+/**
+ * A static cyclic partitioning, which distributes the first `G` axes of the
+ * data cyclically, as `bulk::cyclic_partitioning`.
+ */
+template <int D, int G = D>
+class static_cyclic_partitioning
+    : public static_partitioning_base<static_cyclic_partitioning<D, G>, D, G> {
+  using base = static_partitioning_base<static_cyclic_partitioning<D, G>, D, G>;
+  friend base;
+
+ public:
+  /**
+   * Constructs a cyclic partitioning in nD.
+   *
+   * `data_size`: the global number of elements along each axis
+   * `grid`: the number of processors in each dimension
+   */
+  static_cyclic_partitioning(index_type<D> data_size, index_type<G> grid)
+      : base(data_size, grid) {
+    static_assert(G <= D,
+                  "Dimensionality of the data should be larger or equal to "
+                  "that of the processor grid.");
+    for (int g = 0; g < G; ++g) {
+      div_[g] = util::divider(grid[g]);
+    }
+  }
+
+  /** The number of elements along each axis on processor `t`. */
+  index_type<D> local_size(index_type<G> t) const {
+    auto size = this->global_size_;
+    for (int g = 0; g < G; ++g) {
+      size[g] = (size[g] + this->grid_[g] - t[g] - 1) / this->grid_[g];
+    }
+    return size;
+  }
+  index_type<D> local_size(int t) const {
+    return local_size(this->multi_rank(t));
+  }
+
+  /** Get the multi-dimensional owner of a global index. */
+  index_type<G> multi_owner(index_type<D> xs) const {
+    auto result = index_type<G>{};
+    for (int g = 0; g < G; ++g) {
+      result[g] = xs[g] % this->grid_[g];
+    }
+    return result;
+  }
+
+  /** Convert a global index to a local index on its owner. */
+  index_type<D> local(index_type<D> xs) const {
+    for (int g = 0; g < G; ++g) {
+      auto P = this->grid_[g];
+      xs[g] = this->narrow_ ? base::template divide_<true>(div_[g], P, xs[g])
+                            : base::template divide_<false>(div_[g], P, xs[g]);
+    }
+    return xs;
+  }
+
+  /** Convert a local index on processor `t` to a global index. */
+  index_type<D> global(index_type<D> xs, int t) const {
+    auto u = this->multi_rank(t);
+    for (int g = 0; g < G; ++g) {
+      xs[g] = xs[g] * this->grid_[g] + u[g];
+    }
+    return xs;
+  }
+
+ private:
+  template <bool Narrow>
+  int owner_(index_type<D> xs) const {
+    size_t t = 0;
+    for (int g = 0; g < G; ++g) {
+      t += base::template modulo_<Narrow>(div_[g], this->grid_[g], xs[g]) *
+           this->grid_strides_[g];
+    }
+    return static_cast<int>(t);
+  }
+
+  std::array<util::divider, G> div_;
+};
+
+/**
+ * A static binary-space partitioning, as `bulk::tree_partitioning`, with the
+ * splits flattened into a `util::split_tree`.
+ */
+template <int D>
+class static_tree_partitioning
+    : public static_partitioning_base<static_tree_partitioning<D>, D, 1> {
+  using base = static_partitioning_base<static_tree_partitioning<D>, D, 1>;
+  friend base;
+
+ public:
+  /**
+   * Constructs a tree partitioning in nD.
+   *
+   * `data_size`: the global number of elements along each axis
+   * `procs`: the number of processors, i.e. leaves of the tree
+   * `splits`: the tree of splits, where a split `{d, a}` assigns the elements
+   * with `x[d] <= a` to the left subtree
+   */
+  static_tree_partitioning(index_type<D> data_size, int procs,
+                           const util::binary_tree<util::split>& splits)
+      : base(data_size, {static_cast<size_t>(procs)}),
+        tree_(data_size, splits) {
+    assert(tree_.leaves() == procs);
+  }
+
+  /** The number of elements along each axis on processor `t`. */
+  index_type<D> local_size(int t) const { return tree_.extent(t); }
+
+  /** The global index of the first element of processor `t`. */
+  index_type<D> origin(int t) const { return tree_.origin(t); }
+
+  /** Convert a global index to a local index on its owner. */
+  index_type<D> local(index_type<D> xs) const {
+    auto first = tree_.origin(tree_.find(xs));
+    for (int d = 0; d < D; ++d) {
+      xs[d] -= first[d];
+    }
+    return xs;
+  }
+
+  /** Convert a local index on processor `t` to a global index. */
+  index_type<D> global(index_type<D> xs, int t) const {
+    auto first = tree_.origin(t);
+    for (int d = 0; d < D; ++d) {
+      xs[d] += first[d];
+    }
+    return xs;
+  }
+
+  /** Get the owners of a batch of global indices, see
+   * `static_partitioning_base::owner_batch`. */
+  std::span<int> owner_batch(std::span<const index_type<D>> xs,
+                             std::span<int> owners) const {
+    tree_.find_batch(xs, owners);
+    return owners.first(xs.size());
+  }
+
+ private:
+  // There are no divisions, so `Narrow` is ignored
+  template <bool Narrow>
+  int owner_(index_type<D> xs) const {
+    return tree_.find(xs);
+  }
+
+  util::split_tree<D> tree_;
+};
+
+}  // namespace bulk
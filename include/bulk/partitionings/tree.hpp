@@ -1,3 +1,9 @@
+#pragma once
+
+#include <cassert>
+#include <span>
+
+#include "../util/split_tree.hpp"
 #include "partitioning.hpp"
 
 namespace bulk {
@@ -15,6 +21,12 @@ namespace bulk {
  * (a_n0, d_n0) ...    ...  (a_n(p/2), d_n(p/2))
  *
  * represented as binary tree of splits.
+ *
+ * For the index computations, the splits are flattened into a
+ * `util::split_tree`, so that finding the owner of an index is a branchless
+ * descent through an array. The leaves, i.e. processors, are numbered by
+ * their path, with the direction taken at depth `k` in bit `k`, renumbered
+ * consecutively so that the tree need not be perfect.
  */
 template <int D>
 class tree_partitioning : public rectangular_partitioning<D, 1> {
@@ -24,48 +36,26 @@ class tree_partitioning : public rectangular_partitioning<D, 1> {
   using rectangular_partitioning<D, 1>::local;
 
   /**
-   * Constructs a cyclic partitioning in nD.
+   * Constructs a tree partitioning in nD.
    *
-   * `grid`: the number of processors in each dimension
-   * `data_size`: the global number of processors along each axis
+   * `data_size`: the global number of elements along each axis
+   * `procs`: the number of processors, i.e. leaves of the tree
+   * `splits`: the tree of splits, where a split `{d, a}` assigns the elements
+   * with `x[d] <= a` to the left subtree
    */
   tree_partitioning(index_type<D> data_size, int procs,
                     util::binary_tree<util::split>&& splits)
       : rectangular_partitioning<D, 1>(data_size, {static_cast<size_t>(procs)}),
-        splits_(std::move(splits)) {
-    // resize extents and origins
-    origins_.resize(procs);
-    extents_.resize(procs);
-
-    // compute origins and extents here
-    for (int proc = 0; proc < procs; ++proc) {
-      index_type<D> left_bound{};
-      index_type<D> right_bound = this->global_size_;
-
-      auto node = splits_.root.get();
-      int depth = 0;
-      while (node) {
-        if (proc & (1 << depth)) {
-          left_bound[node->value.d] = node->value.a + 1;
-          node = node->right.get();
-        } else {
-          right_bound[node->value.d] = node->value.a + 1;
-          node = node->left.get();
-        }
-        ++depth;
-      }
-      origins_[proc] = left_bound;
-      for (int d = 0; d < D; ++d) {
-        extents_[proc][d] = right_bound[d] - left_bound[d];
-      }
-    }
+        splits_(std::move(splits)),
+        tree_(data_size, splits_) {
+    assert(tree_.leaves() == procs);
   }
 
   /** Compute the local indices of a element using its global indices */
   index_type<D> local(index_type<D> index) override final {
-    auto t = this->owner(index);
+    auto first = tree_.origin(tree_.find(index));
     for (int d = 0; d < D; ++d) {
-      index[d] -= origins_[t][d];
+      index[d] -= first[d];
     }
     return index;
   }
@@ -73,35 +63,34 @@ class tree_partitioning : public rectangular_partitioning<D, 1> {
   /** The total number of elements along each axis on the processor index with
    * `idxs...` */
   index_type<D> local_size(index_type<1> idxs) override final {
-    return extents_[idxs.get()];
+    return tree_.extent(idxs.get());
   }
 
   index_type<1> multi_owner(index_type<D> xs) override final {
-    // we encode the path to the final volume as a bit pattern, that will be
-    // the processor id
-    auto node = splits_.root.get();
-    size_t proc = 0;
-    size_t depth = 0;
-    while (node) {
-      if (xs[node->value.d] <= node->value.a) {
-        node = node->left.get();
-      } else {
-        proc += 1 << depth;
-        node = node->right.get();
-      }
-      ++depth;
-    }
-    return {proc};
+    return {static_cast<size_t>(tree_.find(xs))};
+  }
+
+  /**
+   * Get the owners of a batch of global indices.
+   *
+   * \param xs the global indices
+   * \param owners room for (at least) the owner of each index
+   * \returns the owners of the indices, i.e. the first `xs.size()` elements of
+   * `owners`
+   */
+  std::span<int> owner_batch(std::span<const index_type<D>> xs,
+                             std::span<int> owners) const {
+    tree_.find_batch(xs, owners);
+    return owners.first(xs.size());
   }
 
-  index_type<D> origin(int t) const override { return origins_[t]; }
+  index_type<D> origin(int t) const override { return tree_.origin(t); }
 
   const auto& splits() const { return splits_; }
 
  private:
   util::binary_tree<util::split> splits_;
-  std::vector<index_type<D>> origins_;
-  std::vector<index_type<D>> extents_;
+  util::split_tree<D> tree_;
 };
 
 }  // namespace bulk
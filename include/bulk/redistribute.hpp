@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "coarray.hpp"
+#include "partitioned_array.hpp"
+#include "partitionings/block.hpp"
+#include "partitionings/partitioning.hpp"
+#include "partitionings/slices.hpp"
+#include "world.hpp"
+
+/**
+ * \file redistribute.hpp
+ *
+ * This header provides the redistribution of distributed data from one
+ * partitioning to another.
+ */
+
+namespace bulk {
+
+namespace detail {
+
+/** A run of local elements that is stored contiguously on the target. */
+struct redistribution_run {
+  size_t src;
+  size_t dst;
+  size_t count;
+};
+
+/**
+ * Compute for each axis the contribution to the (flattened) owner, and the
+ * local index along that axis, of the global indices `globals`. This is only
+ * possible for partitionings where these are determined axis by axis, i.e.
+ * cartesian, block and slices partitionings.
+ *
+ * \returns whether the partitioning is of this kind
+ */
+template <int D, int G>
+bool axis_owners(multi_partitioning<D, G>& part,
+                 const std::array<std::vector<size_t>, D>& globals,
+                 std::array<std::vector<size_t>, D>& ranks,
+                 std::array<std::vector<size_t>, D>& locals) {
+  auto cartesian = dynamic_cast<cartesian_partitioning<D, G>*>(&part);
+  auto block = dynamic_cast<block_partitioning<D, G>*>(&part);
+  // The partitionings into boxes whose origin is determined axis by axis
+  rectangular_partitioning<D, G>* boxes = block;
+  if constexpr (D == G) {
+    if (auto slices = dynamic_cast<slices_partitioning<D>*>(&part)) {
+      boxes = slices;
+    }
+  }
+  if (!cartesian && !boxes) {
+    return false;
+  }
+
+  // The grid axis that partitions each data axis, if any
+  auto grid = part.grid();
+  auto grid_axis = std::array<int, D>{};
+  std::fill(grid_axis.begin(), grid_axis.end(), -1);
+  auto grid_strides = std::array<size_t, G>{};
+  size_t stride = 1;
+  for (int g = 0; g < G; ++g) {
+    grid_strides[g] = stride;
+    stride *= grid[g];
+    grid_axis[block ? block->axes()[g] : g] = g;
+  }
+
+  for (int d = 0; d < D; ++d) {
+    auto g = grid_axis[d];
+    ranks[d].resize(globals[d].size());
+    locals[d].resize(globals[d].size());
+    for (size_t i = 0; i < globals[d].size(); ++i) {
+      auto x = globals[d][i];
+      if (g < 0) {
+        ranks[d][i] = 0;
+        locals[d][i] = x;
+      } else if (cartesian) {
+        ranks[d][i] = cartesian->owner(d, x) * grid_strides[g];
+        locals[d][i] = cartesian->local(d, x);
+      } else {
+        auto xs = index_type<D>{};
+        xs[d] = x;
+        auto owner = boxes->multi_owner(xs);
+        ranks[d][i] = owner[g] * grid_strides[g];
+        locals[d][i] = x - boxes->origin(owner)[d];
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace detail
+
+/**
+ * Redistribute the elements of `src`, distributed according to
+ * `src_partitioning`, to `dst`, distributed according to `dst_partitioning`.
+ *
+ * This takes a single superstep, and ends with a synchronization. The local
+ * elements are flattened as by `bulk::util::flatten`.
+ *
+ * If the source partitioning is cartesian or rectangular, and the
+ * destination partitioning is cartesian, a block or a slices partitioning,
+ * the owners and local indices are computed per axis rather than per
+ * element. Elements that are contiguous both locally and on their target are
+ * sent together, and targets that receive many short runs (e.g. for a cyclic
+ * partitioning) get a single indexed put.
+ *
+ * \param src the local elements in the source partitioning
+ * \param dst the local elements in the destination partitioning, which is a
+ * different coarray than `src`
+ */
+template <typename T, int D, int G, int H>
+void redistribute(bulk::coarray<T>& src,
+                  multi_partitioning<D, G>& src_partitioning,
+                  bulk::coarray<T>& dst,
+                  multi_partitioning<D, H>& dst_partitioning) {
+  auto& world = src.world();
+  auto s = world.rank();
+  auto p = world.active_processors();
+  auto me = src_partitioning.multi_rank(s);
+  auto size = src_partitioning.local_size(me);
+  assert(&src != &dst);
+  assert(src.size() == src_partitioning.local_count(s));
+  assert(dst.size() == dst_partitioning.local_count(s));
+
+  // The strides of the local storage of each processor in the destination
+  auto strides = std::vector<index_type<D>>(p);
+  for (int t = 0; t < p; ++t) {
+    auto extent = dst_partitioning.local_size(t);
+    size_t stride = 1;
+    for (int d = 0; d < D; ++d) {
+      strides[t][d] = stride;
+      stride *= extent[d];
+    }
+  }
+
+  auto runs = std::vector<std::vector<detail::redistribution_run>>(p);
+  auto add = [&](int t, size_t from, size_t to, size_t count) {
+    auto& rs = runs[t];
+    if (!rs.empty() && rs.back().src + rs.back().count == from &&
+        rs.back().dst + rs.back().count == to) {
+      rs.back().count += count;
+    } else {
+      rs.push_back({from, to, count});
+    }
+  };
+
+  auto count = src.size();
+  auto globals = std::array<std::vector<size_t>, D>{};
+  auto ranks = std::array<std::vector<size_t>, D>{};
+  auto locals = std::array<std::vector<size_t>, D>{};
+  if (count == 0) {
+    // nothing to send
+  } else if (detail::local_globals<D, G>(src_partitioning, me, globals) &&
+             detail::axis_owners<D, H>(dst_partitioning, globals, ranks,
+                                       locals)) {
+    // The segments of a row, i.e. a line along the first axis, that have the
+    // same owner and are stored contiguously by it
+    auto segments = std::vector<std::pair<size_t, size_t>>{};
+    for (size_t i = 0; i < size[0]; ++i) {
+      if (i > 0 && ranks[0][i] == ranks[0][i - 1] &&
+          locals[0][i] == locals[0][i - 1] + 1) {
+        segments.back().second += 1;
+      } else {
+        segments.push_back({i, 1});
+      }
+    }
+
+    auto x = index_type<D>{};
+    for (size_t row = 0; row < count / size[0]; ++row) {
+      size_t rank = 0;
+      for (int d = 1; d < D; ++d) {
+        rank += ranks[d][x[d]];
+      }
+      for (auto [i, n] : segments) {
+        auto t = rank + ranks[0][i];
+        auto offset = locals[0][i];
+        for (int d = 1; d < D; ++d) {
+          offset += locals[d][x[d]] * strides[t][d];
+        }
+        add(t, row * size[0] + i, offset, n);
+      }
+      for (int d = 1; d < D; ++d) {
+        if (++x[d] < size[d]) {
+          break;
+        }
+        x[d] = 0;
+      }
+    }
+  } else {
+    auto x = index_type<D>{};
+    for (size_t k = 0; k < count; ++k) {
+      auto global = src_partitioning.global(x, me);
+      auto t = dst_partitioning.owner(global);
+      auto local = dst_partitioning.local(global);
+      size_t offset = 0;
+      for (int d = 0; d < D; ++d) {
+        offset += local[d] * strides[t][d];
+      }
+      add(t, k, offset, 1);
+      for (int d = 0; d < D; ++d) {
+        if (++x[d] < size[d]) {
+          break;
+        }
+        x[d] = 0;
+      }
+    }
+  }
+
+  auto values = std::vector<T>{};
+  auto indices = std::vector<size_t>{};
+  for (int t = 0; t < p; ++t) {
+    auto& rs = runs[t];
+    if (t == s) {
+      for (auto& r : rs) {
+        std::copy_n(src.begin() + r.src, r.count, dst.begin() + r.dst);
+      }
+      continue;
+    }
+    size_t elements = 0;
+    for (auto& r : rs) {
+      elements += r.count;
+    }
+    if (rs.size() * 4 > elements) {
+      // Mostly short runs, which are sent as one indexed put
+      values.clear();
+      indices.clear();
+      for (auto& r : rs) {
+        for (size_t j = 0; j < r.count; ++j) {
+          values.push_back(src[r.src + j]);
+          indices.push_back(r.dst + j);
+        }
+      }
+      dst.put_indexed(t, values, indices);
+    } else {
+      for (auto& r : rs) {
+        dst.put(t, src.begin() + r.src, src.begin() + r.src + r.count, r.dst);
+      }
+    }
+  }
+
+  world.sync();
+}
+
+/**
+ * Redistribute the elements of the partitioned array `src` to the partitioned
+ * array `dst`, which have different partitionings of the same global size.
+ */
+template <typename T, int D, int G, int H>
+void redistribute(partitioned_array<T, D, G>& src,
+                  partitioned_array<T, D, H>& dst) {
+  redistribute(src.storage(), src.partitioning(), dst.storage(),
+               dst.partitioning());
+}
+
+}  // namespace bulk
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "algorithm.hpp"
+#include "coarray.hpp"
+#include "messages.hpp"
+#include "world.hpp"
+
+/**
+ * \file sort.hpp
+ *
+ * This header provides a distributed sample sort, with a radix sort for the
+ * local sorting of integer keys.
+ */
+
+namespace bulk {
+
+/** Options for `bulk::sort`. */
+struct sort_options {
+  /**
+   * The number of samples that each processor takes from its sorted local
+   * elements, per processor in the world. The parts of the sorted sequence
+   * differ from the average by at most about `1 / oversampling` times the
+   * average.
+   */
+  int oversampling = 16;
+
+  /**
+   * Whether equal keys may be divided over several processors. This keeps the
+   * parts balanced if many keys are equal. Otherwise, all elements with equal
+   * keys end up on the same processor.
+   */
+  bool spread_duplicates = true;
+};
+
+namespace detail {
+
+// Sequences shorter than this are sorted with `std::sort` instead of a radix
+// sort
+constexpr std::size_t radix_sort_threshold = 256;
+
+// Whether a radix sort orders values of type `T` as `Compare`
+template <typename T, typename Compare>
+constexpr bool radix_sortable_ =
+    std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+    (std::is_same_v<Compare, std::less<T>> ||
+     std::is_same_v<Compare, std::less<>>);
+
+/**
+ * Sort integers with a least-significant-digit radix sort on bytes.
+ *
+ * The histograms of all digits are counted in a single pass over the values,
+ * and a digit that is the same for all values is skipped.
+ */
+template <typename T>
+void radix_sort_(std::span<T> xs) {
+  using U = std::make_unsigned_t<T>;
+  constexpr int digits = sizeof(T);
+  // Flipping the sign bit orders signed values as their unsigned keys
+  constexpr U flip = std::is_signed_v<T> ? U(U(1) << (8 * sizeof(T) - 1)) : 0;
+  auto n = xs.size();
+  if (n < radix_sort_threshold) {
+    std::sort(xs.begin(), xs.end());
+    return;
+  }
+
+  auto digit = [](T x, int d) {
+    return static_cast<std::size_t>((U(x) ^ flip) >> (8 * d)) & 0xff;
+  };
+  auto counts = std::array<std::array<std::size_t, 256>, digits>{};
+  for (auto x : xs) {
+    for (int d = 0; d < digits; ++d) {
+      ++counts[d][digit(x, d)];
+    }
+  }
+
+  auto buffer = std::vector<T>(n);
+  T* from = xs.data();
+  T* to = buffer.data();
+  for (int d = 0; d < digits; ++d) {
+    auto& count = counts[d];
+    if (count[digit(from[0], d)] == n) {
+      continue;
+    }
+    std::size_t offset = 0;
+    for (auto& c : count) {
+      offset += std::exchange(c, offset);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      to[count[digit(from[i], d)]++] = from[i];
+    }
+    std::swap(from, to);
+  }
+  if (from != xs.data()) {
+    std::copy(from, from + n, xs.data());
+  }
+}
+
+// Sort the local values, with a radix sort if it orders them as `comp`
+template <typename T, typename Compare>
+void local_sort_(std::span<T> xs, Compare comp) {
+  if constexpr (radix_sortable_<T, Compare>) {
+    radix_sort_(xs);
+  } else {
+    std::sort(xs.begin(), xs.end(), comp);
+  }
+}
+
+/**
+ * Merge the sorted runs `runs` into `out`, in a single pass.
+ *
+ * The runs are the leaves of a tournament tree, whose inner nodes hold the
+ * loser of the comparison of the winners of their children. After the
+ * overall winner is output, only the path from its leaf to the root is
+ * replayed, i.e. `log k` comparisons for `k` runs.
+ */
+template <typename T, typename Compare>
+T* merge_runs_(std::vector<std::span<const T>> runs, T* out, Compare comp) {
+  std::erase_if(runs, [](const auto& run) { return run.empty(); });
+  auto k = runs.size();
+  if (k <= 1) {
+    return k == 0 ? out : std::copy(runs[0].begin(), runs[0].end(), out);
+  }
+
+  // An exhausted run loses against all others
+  auto less = [&](std::size_t a, std::size_t b) {
+    return !runs[a].empty() &&
+           (runs[b].empty() || comp(runs[a].front(), runs[b].front()));
+  };
+  // The nodes `1, ..., k - 1` are inner nodes, and `k + r` is the leaf of
+  // run `r`
+  auto winners = std::vector<std::size_t>(2 * k);
+  auto losers = std::vector<std::size_t>(k);
+  for (std::size_t r = 0; r < k; ++r) {
+    winners[k + r] = r;
+  }
+  for (auto i = k - 1; i >= 1; --i) {
+    auto a = winners[2 * i];
+    auto b = winners[2 * i + 1];
+    winners[i] = less(b, a) ? b : a;
+    losers[i] = less(b, a) ? a : b;
+  }
+
+  auto winner = winners[1];
+  while (!runs[winner].empty()) {
+    *out++ = runs[winner].front();
+    runs[winner] = runs[winner].subspan(1);
+    for (auto i = (k + winner) / 2; i >= 1; i /= 2) {
+      if (less(losers[i], winner)) {
+        std::swap(losers[i], winner);
+      }
+    }
+  }
+  return out;
+}
+
+/**
+ * A sample of the sorted local values of a processor. Samples (and elements)
+ * are ordered by their value, and equal values by their rank and local index,
+ * so that equal values can be divided over several processors. The `weight`
+ * of a sample is the number of local values it represents.
+ */
+template <typename T>
+struct sort_sample_ {
+  T value;
+  int rank;
+  std::size_t index;
+  std::size_t weight;
+};
+
+/**
+ * Choose `p - 1` splitters among the sorted samples, such that the total
+ * weight between consecutive splitters is about equal. A splitter with rank
+ * `p` lies beyond all elements.
+ */
+template <typename T>
+std::vector<sort_sample_<T>> choose_splitters_(
+    std::span<const sort_sample_<T>> samples, int p) {
+  std::size_t total = 0;
+  for (const auto& sample : samples) {
+    total += sample.weight;
+  }
+  auto splitters = std::vector<sort_sample_<T>>(p - 1);
+  std::size_t before = 0;
+  std::size_t i = 0;
+  for (int t = 1; t < p; ++t) {
+    auto target = total * t / p;
+    while (i < samples.size() && before < target) {
+      before += samples[i++].weight;
+    }
+    splitters[t - 1] =
+        i < samples.size() ? samples[i] : sort_sample_<T>{{}, p, 0, 0};
+  }
+  return splitters;
+}
+
+}  // namespace detail
+
+/**
+ * Sort distributed values with a sample sort.
+ *
+ * Each processor sorts its local values, with a radix sort for integers
+ * ordered by `std::less`, and takes `options.oversampling * p` regularly
+ * spaced samples. The samples are merged on the first processor, which
+ * chooses `p - 1` splitters that divide the values into parts of about equal
+ * size, and broadcasts these. Each processor then sends the values between
+ * consecutive splitters to the corresponding processor, which merges the
+ * received sorted runs in a single pass (or radix sorts them, for integers).
+ *
+ * The result of processor `s` is a sorted part of the values, and the parts
+ * are in rank order. Their sizes differ by about `n / oversampling` for `n`
+ * values per processor, also if many values are equal, unless
+ * `options.spread_duplicates` is false.
+ *
+ * Requires `T` to be trivially copyable.
+ *
+ * The cost is about `(n / p) log(n / p) + 2 * (n / p) * g + 3 * l`, with an
+ * additional `oversampling * p^2` samples that are merged on the first
+ * processor.
+ *
+ * \param world the world in which the values are sorted
+ * \param xs the local values
+ * \param comp the ordering of the values
+ * \param options the sampling options
+ *
+ * \returns the local part of the sorted values
+ */
+template <typename T, typename Compare = std::less<>>
+std::vector<std::remove_const_t<T>> sort(bulk::world& world, std::span<T> xs,
+                                         Compare comp = {},
+                                         sort_options options = {}) {
+  using V = std::remove_const_t<T>;
+  using sample = detail::sort_sample_<V>;
+  static_assert(std::is_trivially_copyable_v<V>,
+                "sort only supports trivially-copyable types");
+  auto p = world.active_processors();
+  auto s = world.rank();
+
+  // (1) Sort the local values
+  auto local = std::vector<V>(xs.begin(), xs.end());
+  detail::local_sort_<V>(local, comp);
+  if (p == 1) {
+    return local;
+  }
+
+  // (2) Take regularly spaced samples, and merge them on the first processor
+  auto n = local.size();
+  auto k = std::min<std::size_t>(n, options.oversampling * p);
+  auto samples = std::vector<sample>(k);
+  for (std::size_t j = 0; j < k; ++j) {
+    auto index = j * n / k;
+    auto next = (j + 1) * n / k;
+    samples[j] = {local[index], s, index, next - index};
+  }
+  auto before = [&](const sample& lhs, const sample& rhs) {
+    if (comp(lhs.value, rhs.value)) {
+      return true;
+    }
+    if (comp(rhs.value, lhs.value)) {
+      return false;
+    }
+    return std::tie(lhs.rank, lhs.index) < std::tie(rhs.rank, rhs.index);
+  };
+  auto sample_queue = bulk::queue<std::span<const sample>>(world);
+  if (k > 0) {
+    sample_queue(0).send(std::span<const sample>(samples));
+  }
+  world.sync();
+
+  // (3) Choose the splitters, and broadcast them
+  auto splitters = std::vector<sample>(p - 1);
+  if (s == 0) {
+    auto runs = std::vector<std::span<const sample>>(sample_queue.begin(),
+                                                     sample_queue.end());
+    auto total = std::size_t{0};
+    for (const auto& run : runs) {
+      total += run.size();
+    }
+    auto merged = std::vector<sample>(total);
+    detail::merge_runs_(std::move(runs), merged.data(), before);
+    splitters = detail::choose_splitters_<V>(merged, p);
+  }
+  bulk::broadcast(world, std::span(splitters), 0);
+
+  // (4) Find the local values between consecutive splitters
+  auto bounds = std::vector<std::size_t>(p + 1);
+  bounds[p] = n;
+  for (int t = 1; t < p; ++t) {
+    const auto& splitter = splitters[t - 1];
+    auto bound = n;
+    if (splitter.rank < p) {
+      auto equal = std::equal_range(local.begin() + bounds[t - 1], local.end(),
+                                    splitter.value, comp);
+      auto lo = static_cast<std::size_t>(equal.first - local.begin());
+      auto hi = static_cast<std::size_t>(equal.second - local.begin());
+      bound = lo;
+      if (options.spread_duplicates) {
+        // equal values before the splitter in (rank, index) order
+        bound = s < splitter.rank    ? hi
+                : s > splitter.rank ? lo
+                                    : std::clamp(splitter.index, lo, hi);
+      }
+    }
+    bounds[t] = std::max(bound, bounds[t - 1]);
+  }
+
+  // (5) Send the values to their processors
+  auto q = bulk::queue<std::span<const V>>(world);
+  for (int t = 0; t < p; ++t) {
+    if (bounds[t + 1] > bounds[t]) {
+      q(t).send(std::span<const V>(local.data() + bounds[t],
+                                   bounds[t + 1] - bounds[t]));
+    }
+  }
+  world.sync();
+
+  // (6) Merge the received runs. Integers are radix sorted instead, which
+  // takes a few passes over the values regardless of the number of runs
+  auto runs = std::vector<std::span<const V>>(q.begin(), q.end());
+  auto total = std::size_t{0};
+  for (const auto& run : runs) {
+    total += run.size();
+  }
+  auto result = std::vector<V>(total);
+  if constexpr (detail::radix_sortable_<V, Compare>) {
+    auto out = result.data();
+    for (const auto& run : runs) {
+      out = std::copy(run.begin(), run.end(), out);
+    }
+    detail::radix_sort_<V>(result);
+  } else {
+    detail::merge_runs_(std::move(runs), result.data(), comp);
+  }
+  return result;
+}
+
+/**
+ * Sort the values of a coarray, see `sort(bulk::world&, std::span<T>, ...)`.
+ *
+ * \returns a coarray with the local part of the sorted values, whose local
+ * size can differ from that of `xs`
+ */
+template <typename T, typename Compare = std::less<>>
+bulk::coarray<T> sort(bulk::coarray<T>& xs, Compare comp = {},
+                      sort_options options = {}) {
+  auto& world = xs.world();
+  auto sorted = bulk::sort(world, std::span<const T>(xs.data(), xs.size()),
+                           comp, options);
+  auto result = bulk::coarray<T>(world, sorted.size());
+  std::copy(sorted.begin(), sorted.end(), result.begin());
+  return result;
+}
+
+}  // namespace bulk
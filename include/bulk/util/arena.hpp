@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * \file arena.hpp
+ *
+ * This header provides a chunked bump allocator, used for the variable-length
+ * content of received messages.
+ */
+
+namespace bulk::detail {
+
+/**
+ * A bump allocator that hands out memory from a list of chunks.
+ *
+ * Allocated memory is never moved, so that views into it remain valid until
+ * the arena is cleared. Clearing keeps the largest chunk, so that an arena
+ * that is cleared e.g. once per superstep stops allocating once it is large
+ * enough.
+ */
+class arena {
+ public:
+  arena() = default;
+  arena(const arena&) = delete;
+  void operator=(const arena&) = delete;
+
+  /** Allocate `size` bytes, aligned to `alignment`. */
+  void* allocate(std::size_t size, std::size_t alignment) {
+    auto offset = (used_ + alignment - 1) / alignment * alignment;
+    if (chunks_.empty() || offset + size > capacity_) {
+      add_chunk_(size);
+      offset = 0;
+    }
+    used_ = offset + size;
+    return reinterpret_cast<char*>(chunks_.back().get()) + offset;
+  }
+
+  /** Allocate room for `count` values of type `T`. */
+  template <typename T>
+  T* allocate(std::size_t count) {
+    return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+  }
+
+  /** Release all allocations, keeping the largest chunk. */
+  void clear() {
+    if (chunks_.size() > 1) {
+      // The last chunk is the largest
+      std::swap(chunks_.front(), chunks_.back());
+      chunks_.resize(1);
+    }
+    used_ = 0;
+  }
+
+ private:
+  static constexpr std::size_t min_chunk_ = 4096;
+
+  void add_chunk_(std::size_t size) {
+    capacity_ = std::max({size, min_chunk_, 2 * capacity_});
+    // Chunks of `std::max_align_t` are suitably aligned for any type
+    auto count = (capacity_ + sizeof(std::max_align_t) - 1) /
+                 sizeof(std::max_align_t);
+    capacity_ = count * sizeof(std::max_align_t);
+    chunks_.emplace_back(new std::max_align_t[count]);
+  }
+
+  std::vector<std::unique_ptr<std::max_align_t[]>> chunks_;
+  std::size_t capacity_ = 0;
+  std::size_t used_ = 0;
+};
+
+}  // namespace bulk::detail
@@ -17,6 +17,7 @@ struct binary_tree {
   binary_tree() = default;
   binary_tree(T t) { root = std::make_unique<node>(t); }
   binary_tree(binary_tree&& other) : root(std::move(other.root)) {}
+  binary_tree& operator=(binary_tree&& other) = default;
 
   enum class dir { left, right };
 
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+/**
+ * \file divider.hpp
+ *
+ * This header provides division by a divisor that is fixed at runtime, using
+ * a multiplication instead of a (slow) hardware division.
+ */
+
+namespace bulk::util {
+
+/**
+ * Divides 32-bit unsigned integers by a fixed divisor.
+ *
+ * The quotient and remainder are computed from a precomputed 64-bit
+ * reciprocal of the divisor, with a multiplication and a shift, as in
+ * D. Lemire et al., "Faster remainder by direct computation" (2019). This is
+ * exact for all 32-bit dividends and divisors.
+ */
+class divider {
+ public:
+  divider() : divider(1) {}
+
+  /** Construct a divider for a non-zero divisor `d`. */
+  explicit divider(std::uint32_t d)
+      : d_(d), m_(d == 1 ? 0 : UINT64_MAX / d + 1) {
+    assert(d != 0);
+  }
+
+  /** The quotient `n / d`. */
+  std::uint32_t divide(std::uint32_t n) const {
+#ifdef __SIZEOF_INT128__
+    auto q = static_cast<std::uint32_t>(
+        (static_cast<__uint128_t>(m_) * n) >> 64);
+    // the reciprocal of 1 does not fit in 64 bits
+    return m_ == 0 ? n : q;
+#else
+    return n / d_;
+#endif
+  }
+
+  /** The remainder `n % d`. */
+  std::uint32_t modulo(std::uint32_t n) const {
+#ifdef __SIZEOF_INT128__
+    std::uint64_t fraction = m_ * n;
+    return static_cast<std::uint32_t>(
+        (static_cast<__uint128_t>(fraction) * d_) >> 64);
+#else
+    return n % d_;
+#endif
+  }
+
+  /** The divisor. */
+  std::uint32_t divisor() const { return d_; }
+
+ private:
+  std::uint32_t d_;
+  std::uint64_t m_;
+};
+
+}  // namespace bulk::util
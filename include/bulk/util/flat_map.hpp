@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \file flat_map.hpp
+ *
+ * This header provides a hash map with open addressing, that stores its
+ * entries contiguously.
+ */
+
+namespace bulk::util {
+
+/**
+ * A hash map with open addressing and linear probing.
+ *
+ * The entries are stored densely in insertion order, and the table of slots
+ * only holds (one plus) the index of an entry. Iterating over the map is a
+ * linear scan over the entries, and a lookup probes a compact array of
+ * integers. Clearing the map keeps the allocated memory, so that a map can
+ * be reused without allocations, e.g. once per superstep.
+ *
+ * \tparam Key the type of the keys
+ * \tparam Value the type of the values
+ * \tparam Hash the hash function for the keys
+ * \tparam Equal the equality predicate for the keys
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+class flat_map {
+ public:
+  using value_type = std::pair<Key, Value>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  flat_map() = default;
+
+  /** Construct an empty map with room for `capacity` entries. */
+  explicit flat_map(std::size_t capacity) { reserve(capacity); }
+
+  /** Make room for `capacity` entries, so that inserting them does not
+   * rehash. */
+  void reserve(std::size_t capacity) {
+    entries_.reserve(capacity);
+    auto slots = min_slots_;
+    while (slots * max_load_ < capacity) {
+      slots *= 2;
+    }
+    if (slots > slots_.size()) {
+      rehash_(slots);
+    }
+  }
+
+  /**
+   * Find the value for `key`.
+   *
+   * \returns a pointer to the value, or `nullptr` if `key` is not in the map
+   */
+  Value* find(const Key& key) {
+    if (slots_.empty()) {
+      return nullptr;
+    }
+    auto i = probe_(key);
+    return slots_[i] ? &entries_[slots_[i] - 1].second : nullptr;
+  }
+
+  /**
+   * Insert `value` for `key`, unless `key` is already in the map.
+   *
+   * \returns a pointer to the value for `key`, and whether it was inserted
+   */
+  std::pair<Value*, bool> try_emplace(const Key& key, Value value = {}) {
+    if ((entries_.size() + 1) * max_load_ > slots_.size()) {
+      rehash_(slots_.empty() ? min_slots_ : 2 * slots_.size());
+    }
+    auto i = probe_(key);
+    if (slots_[i]) {
+      return {&entries_[slots_[i] - 1].second, false};
+    }
+    entries_.emplace_back(key, std::move(value));
+    slots_[i] = static_cast<std::uint32_t>(entries_.size());
+    return {&entries_.back().second, true};
+  }
+
+  /** Get the value for `key`, inserting a default value if needed. */
+  Value& operator[](const Key& key) { return *try_emplace(key).first; }
+
+  /**
+   * Combine `value` into the value for `key`, or insert it if `key` is not
+   * in the map.
+   *
+   * \param f a binary function `(Value&, Value) -> void` or a binary operator
+   * such as `std::plus<Value>`
+   */
+  template <typename Func>
+  void combine(const Key& key, Value value, Func& f) {
+    auto [current, inserted] = try_emplace(key, value);
+    if (!inserted) {
+      if constexpr (std::is_void_v<std::invoke_result_t<Func&, Value&,
+                                                        Value&>>) {
+        f(*current, value);
+      } else {
+        *current = f(*current, value);
+      }
+    }
+  }
+
+  /** Remove all entries, keeping the allocated memory. */
+  void clear() {
+    if (!entries_.empty()) {
+      entries_.clear();
+      std::fill(slots_.begin(), slots_.end(), 0);
+    }
+  }
+
+  /** The number of entries. */
+  std::size_t size() const { return entries_.size(); }
+
+  /** Check if the map is empty. */
+  bool empty() const { return entries_.empty(); }
+
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+ private:
+  static constexpr std::size_t min_slots_ = 16;
+  static constexpr std::size_t max_load_ = 2;  // i.e. load factor of 1 / 2
+
+  // The slot for `key`, i.e. the slot holding it or the empty slot where it
+  // would be inserted
+  std::size_t probe_(const Key& key) const {
+    auto mask = slots_.size() - 1;
+    // Fibonacci hashing, so that e.g. the identity hash of integers spreads
+    // consecutive keys over the table
+    auto i = static_cast<std::size_t>(
+        (static_cast<std::uint64_t>(Hash{}(key)) * 0x9e3779b97f4a7c15ull) >>
+        32);
+    for (i &= mask; slots_[i]; i = (i + 1) & mask) {
+      if (Equal{}(entries_[slots_[i] - 1].first, key)) {
+        break;
+      }
+    }
+    return i;
+  }
+
+  void rehash_(std::size_t slots) {
+    slots_.assign(slots, 0);
+    for (auto j = 0u; j < entries_.size(); ++j) {
+      slots_[probe_(entries_[j].first)] = j + 1;
+    }
+  }
+
+  std::vector<value_type> entries_;
+  std::vector<std::uint32_t> slots_;
+};
+
+}  // namespace bulk::util
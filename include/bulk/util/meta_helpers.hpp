@@ -1,16 +1,20 @@
 #pragma once
 
+#include <span>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "serialize.hpp"
+
 namespace bulk::meta {
 
 template <typename T>
 struct representation {
-  static_assert(std::is_trivially_copyable<T>::value,
-                "Only trivially copyable types are supported as `T` for "
-                "distributed variables and queues");
+  static_assert(bulk::detail::serializable<T>(),
+                "Only trivially copyable types, and (aggregates of) strings "
+                "and standard containers of supported types are supported as "
+                "`T` for distributed variables and queues");
   using type = T;
 };
 
@@ -24,6 +28,18 @@ struct representation<std::string> {
   using type = std::string;
 };
 
+// The type with which a component of a message can be sent without first
+// copying it into its representation, i.e. a span for arrays
+template <typename T>
+struct view_representation {
+  using type = const typename representation<T>::type&;
+};
+
+template <typename T>
+struct view_representation<T[]> {
+  using type = std::span<const T>;
+};
+
 // Partial specialization of alias templates is not allowed, so we need this
 // indirection
 template <typename Enable, typename... Ts>
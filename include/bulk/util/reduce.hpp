@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <type_traits>
+
+/**
+ * \file reduce.hpp
+ *
+ * This header provides the operators and element-wise kernels that are used
+ * to combine values in the reductions of `algorithm.hpp`.
+ */
+
+namespace bulk {
+
+/** Function object that returns the largest of its arguments. */
+template <typename T = void>
+struct maximum {
+  constexpr T operator()(const T& lhs, const T& rhs) const {
+    return lhs < rhs ? rhs : lhs;
+  }
+};
+
+template <>
+struct maximum<void> {
+  template <typename T>
+  constexpr T operator()(const T& lhs, const T& rhs) const {
+    return lhs < rhs ? rhs : lhs;
+  }
+};
+
+/** Function object that returns the smallest of its arguments. */
+template <typename T = void>
+struct minimum {
+  constexpr T operator()(const T& lhs, const T& rhs) const {
+    return rhs < lhs ? rhs : lhs;
+  }
+};
+
+template <>
+struct minimum<void> {
+  template <typename T>
+  constexpr T operator()(const T& lhs, const T& rhs) const {
+    return rhs < lhs ? rhs : lhs;
+  }
+};
+
+/** Reductions that backends can implement natively. */
+enum class reduce_op { sum, product, min, max };
+
+/** Element types that backends can reduce natively. */
+enum class scalar_type { int32, uint32, int64, uint64, float32, float64 };
+
+}  // namespace bulk
+
+namespace bulk::detail {
+
+/** The native element type corresponding to `T`, if any. */
+template <typename T>
+constexpr std::optional<scalar_type> scalar_type_of() {
+  if constexpr (std::is_same_v<T, bool> || !std::is_arithmetic_v<T>) {
+    return {};
+  } else if constexpr (std::is_floating_point_v<T>) {
+    if constexpr (std::is_same_v<T, float>) {
+      return scalar_type::float32;
+    } else if constexpr (std::is_same_v<T, double>) {
+      return scalar_type::float64;
+    } else {
+      return {};
+    }
+  } else if constexpr (sizeof(T) == 4) {
+    return std::is_signed_v<T> ? scalar_type::int32 : scalar_type::uint32;
+  } else if constexpr (sizeof(T) == 8) {
+    return std::is_signed_v<T> ? scalar_type::int64 : scalar_type::uint64;
+  } else {
+    return {};
+  }
+}
+
+/** The native reduction corresponding to the operator `Op` on `T`, if any. */
+template <typename T, typename Op>
+constexpr std::optional<reduce_op> reduce_op_of() {
+  if constexpr (std::is_same_v<Op, std::plus<T>> ||
+                std::is_same_v<Op, std::plus<>>) {
+    return reduce_op::sum;
+  } else if constexpr (std::is_same_v<Op, std::multiplies<T>> ||
+                       std::is_same_v<Op, std::multiplies<>>) {
+    return reduce_op::product;
+  } else if constexpr (std::is_same_v<Op, bulk::minimum<T>> ||
+                       std::is_same_v<Op, bulk::minimum<>>) {
+    return reduce_op::min;
+  } else if constexpr (std::is_same_v<Op, bulk::maximum<T>> ||
+                       std::is_same_v<Op, bulk::maximum<>>) {
+    return reduce_op::max;
+  } else {
+    return {};
+  }
+}
+
+/** The size in bytes of a native element type. */
+inline std::size_t size_of(scalar_type type) {
+  switch (type) {
+    case scalar_type::int32:
+    case scalar_type::uint32:
+    case scalar_type::float32:
+      return 4;
+    default:
+      return 8;
+  }
+}
+
+/**
+ * Combine `rhs` into `lhs` using `f`.
+ *
+ * `f` is either a folding function of the form `(T&, T) -> void` that
+ * modifies its first argument, or a binary operator such as `std::plus<T>`
+ * that returns the combined value.
+ */
+template <typename T, typename Func>
+inline void combine(T& lhs, T& rhs, Func& f) {
+  if constexpr (std::is_void_v<std::invoke_result_t<Func&, T&, T&>>) {
+    f(lhs, rhs);
+  } else {
+    lhs = f(lhs, rhs);
+  }
+}
+
+/**
+ * Combine `n` values of `src` element-wise into `dst`.
+ *
+ * The arrays may not overlap. This is a plain loop over contiguous memory,
+ * which the compiler vectorizes for arithmetic types and the standard
+ * operators.
+ */
+template <typename T, typename Func>
+void combine_n(T* __restrict dst, T* __restrict src, std::size_t n, Func& f) {
+  for (std::size_t i = 0; i < n; ++i) {
+    combine(dst[i], src[i], f);
+  }
+}
+
+template <typename T>
+void combine_n(T* dst, const T* src, std::size_t n, reduce_op op) {
+  switch (op) {
+    case reduce_op::sum: {
+      auto f = std::plus<T>{};
+      combine_n(dst, const_cast<T*>(src), n, f);
+    } break;
+    case reduce_op::product: {
+      auto f = std::multiplies<T>{};
+      combine_n(dst, const_cast<T*>(src), n, f);
+    } break;
+    case reduce_op::min: {
+      auto f = bulk::minimum<T>{};
+      combine_n(dst, const_cast<T*>(src), n, f);
+    } break;
+    case reduce_op::max: {
+      auto f = bulk::maximum<T>{};
+      combine_n(dst, const_cast<T*>(src), n, f);
+    } break;
+  }
+}
+
+/**
+ * Combine `count` elements of type `type` at `src` element-wise into `dst`
+ * using the reduction `op`. This is used by backends that implement the
+ * collectives natively.
+ */
+inline void combine(void* dst, const void* src, std::size_t count,
+                    scalar_type type, reduce_op op) {
+  switch (type) {
+    case scalar_type::int32:
+      combine_n((int32_t*)dst, (const int32_t*)src, count, op);
+      break;
+    case scalar_type::uint32:
+      combine_n((uint32_t*)dst, (const uint32_t*)src, count, op);
+      break;
+    case scalar_type::int64:
+      combine_n((int64_t*)dst, (const int64_t*)src, count, op);
+      break;
+    case scalar_type::uint64:
+      combine_n((uint64_t*)dst, (const uint64_t*)src, count, op);
+      break;
+    case scalar_type::float32:
+      combine_n((float*)dst, (const float*)src, count, op);
+      break;
+    case scalar_type::float64:
+      combine_n((double*)dst, (const double*)src, count, op);
+      break;
+  }
+}
+
+}  // namespace bulk::detail
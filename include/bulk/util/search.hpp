@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+/**
+ * \file search.hpp
+ *
+ * This header provides a binary search without branches, for lookups in
+ * short sorted arrays such as the boundaries of the parts of a partitioning.
+ */
+
+namespace bulk::util {
+
+/**
+ * The number of elements of the sorted range `xs` that are at most `key`,
+ * i.e. the position returned by `std::upper_bound`.
+ *
+ * The search halves the range with conditional moves instead of branches,
+ * so that its cost does not depend on how predictable the keys are, and the
+ * searches for different keys can overlap.
+ */
+template <typename T>
+size_t upper_bound_index(std::span<const T> xs, T key) {
+  if (xs.empty()) {
+    return 0;
+  }
+  auto base = xs.data();
+  auto n = xs.size();
+  while (n > 1) {
+    auto half = n / 2;
+    base = base[half] <= key ? base + half : base;
+    n -= half;
+  }
+  return static_cast<size_t>(base - xs.data()) + (*base <= key);
+}
+
+}  // namespace bulk::util
@@ -1,77 +1,464 @@
 #pragma once
 
+#include <array>
 #include <cstring>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "arena.hpp"
+
+/**
+ * \file serialize.hpp
+ *
+ * This header provides the serialization of values that are communicated
+ * through variables and queues.
+ *
+ * Trivially-copyable values are copied as is. Furthermore, strings, vectors,
+ * arrays, optionals, maps, pairs and tuples are supported, as well as
+ * aggregates (i.e. simple structs) of supported types, which are decomposed
+ * into their fields. Such aggregates can have at most 12 fields, no base
+ * classes, and no built-in array members (use `std::array` instead). Types
+ * whose serialized size does not depend on their value (see `fixed_size`) are
+ * sized at compile time, so that sending them needs no separate pass to
+ * compute the size.
+ */
 
 namespace bulk::detail {
 
-struct scale {
-  std::size_t size = 0;
+// Structural decomposition of aggregates
+
+// Converts to any field type, used to count the fields of an aggregate
+struct any_field {
+  template <typename T>
+  operator T&() const&&;
+};
 
-  template <typename T,
-            typename = std::enable_if_t<std::is_trivially_copyable<T>::value>>
-  void operator|(const T&) {
-    size += sizeof(T);
+template <typename T, typename... Fields>
+constexpr std::size_t field_count_() {
+  if constexpr (requires { T{Fields{}..., any_field{}}; }) {
+    return field_count_<T, Fields..., any_field>();
+  } else {
+    return sizeof...(Fields);
   }
+}
+
+/**
+ * The number of fields of an aggregate. This is only correct for aggregates
+ * without base classes and built-in array members, see `decomposable_`.
+ */
+template <typename T>
+constexpr std::size_t field_count = field_count_<T>();
+
+// The maximum number of fields of an aggregate that can be decomposed
+constexpr std::size_t max_field_count = 12;
 
-  void operator|(const std::string& str) {
-    size += (str.size() + 1) * sizeof(char);
+// Converts only to the base classes of `T`, used to detect them
+template <typename T>
+struct any_base {
+  template <typename U>
+    requires(std::is_base_of_v<U, T> && !std::is_same_v<U, T>)
+  operator U&() const&&;
+};
+
+// Whether an aggregate has a base class, which is initialized first
+template <typename T>
+constexpr bool has_base_ = requires { T{any_base<T>{}}; };
+
+// Whether `T` has `N` fields that can each be initialized from empty braces.
+// Braces are not elided for these, so unlike for `any_field`, a built-in
+// array member counts as one field.
+template <typename T, std::size_t N>
+constexpr bool braced_fields_() {
+  if constexpr (N == 1) {
+    return requires { T{{}}; };
+  } else if constexpr (N == 2) {
+    return requires { T{{}, {}}; };
+  } else if constexpr (N == 3) {
+    return requires { T{{}, {}, {}}; };
+  } else if constexpr (N == 4) {
+    return requires { T{{}, {}, {}, {}}; };
+  } else if constexpr (N == 5) {
+    return requires { T{{}, {}, {}, {}, {}}; };
+  } else if constexpr (N == 6) {
+    return requires { T{{}, {}, {}, {}, {}, {}}; };
+  } else if constexpr (N == 7) {
+    return requires { T{{}, {}, {}, {}, {}, {}, {}}; };
+  } else if constexpr (N == 8) {
+    return requires { T{{}, {}, {}, {}, {}, {}, {}, {}}; };
+  } else if constexpr (N == 9) {
+    return requires { T{{}, {}, {}, {}, {}, {}, {}, {}, {}}; };
+  } else if constexpr (N == 10) {
+    return requires { T{{}, {}, {}, {}, {}, {}, {}, {}, {}, {}}; };
+  } else if constexpr (N == 11) {
+    return requires { T{{}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}}; };
+  } else if constexpr (N == 12) {
+    return requires { T{{}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}}; };
+  } else {
+    return false;
   }
+}
 
-  template <typename T>
-  void operator|(const std::vector<T>& xs) {
-    size += sizeof(int) + xs.size() * sizeof(T);
+// Whether the fields of the aggregate `T` are counted correctly, and can be
+// bound by a structured binding. Brace elision counts each element of a
+// built-in array member as a field, and the fields of a base class cannot be
+// bound together with those of the derived class.
+template <typename T>
+constexpr bool decomposable_ =
+    field_count<T> <= max_field_count && !has_base_<T> &&
+    braced_fields_<T, field_count<T>>();
+
+/** A tuple of references to the fields of the aggregate `x`. */
+template <typename T>
+auto fields(T& x) {
+  using U = std::remove_cv_t<T>;
+  constexpr auto n = field_count<U>;
+  static_assert(n <= max_field_count,
+                "Aggregates are only serialized up to 12 fields");
+  static_assert(!has_base_<U>,
+                "Aggregates with a base class cannot be serialized");
+  static_assert(n > max_field_count || has_base_<U> ||
+                    braced_fields_<U, n>(),
+                "Aggregates with built-in array members cannot be serialized, "
+                "use std::array instead");
+  if constexpr (!decomposable_<U>) {
+    // Only the assertions above are reported
+    return std::tuple<>{};
+  } else if constexpr (n == 1) {
+    auto& [a] = x;
+    return std::tie(a);
+  } else if constexpr (n == 2) {
+    auto& [a, b] = x;
+    return std::tie(a, b);
+  } else if constexpr (n == 3) {
+    auto& [a, b, c] = x;
+    return std::tie(a, b, c);
+  } else if constexpr (n == 4) {
+    auto& [a, b, c, d] = x;
+    return std::tie(a, b, c, d);
+  } else if constexpr (n == 5) {
+    auto& [a, b, c, d, e] = x;
+    return std::tie(a, b, c, d, e);
+  } else if constexpr (n == 6) {
+    auto& [a, b, c, d, e, f] = x;
+    return std::tie(a, b, c, d, e, f);
+  } else if constexpr (n == 7) {
+    auto& [a, b, c, d, e, f, g] = x;
+    return std::tie(a, b, c, d, e, f, g);
+  } else if constexpr (n == 8) {
+    auto& [a, b, c, d, e, f, g, h] = x;
+    return std::tie(a, b, c, d, e, f, g, h);
+  } else if constexpr (n == 9) {
+    auto& [a, b, c, d, e, f, g, h, i] = x;
+    return std::tie(a, b, c, d, e, f, g, h, i);
+  } else if constexpr (n == 10) {
+    auto& [a, b, c, d, e, f, g, h, i, j] = x;
+    return std::tie(a, b, c, d, e, f, g, h, i, j);
+  } else if constexpr (n == 11) {
+    auto& [a, b, c, d, e, f, g, h, i, j, k] = x;
+    return std::tie(a, b, c, d, e, f, g, h, i, j, k);
+  } else {
+    auto& [a, b, c, d, e, f, g, h, i, j, k, l] = x;
+    return std::tie(a, b, c, d, e, f, g, h, i, j, k, l);
   }
+}
+
+// Classification of the supported types
+
+template <typename T>
+struct is_std_array : std::false_type {};
+template <typename T, std::size_t N>
+struct is_std_array<std::array<T, N>> : std::true_type {};
+
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T>
+struct is_vector<std::vector<T>> : std::true_type {};
+
+// Spans and string views are serialized as vectors and strings. They can only
+// be received by queues, that point them into memory they own.
+template <typename T>
+struct is_span : std::false_type {};
+template <typename T>
+struct is_span<std::span<T>> : std::true_type {};
+
+template <typename T>
+concept view = is_span<T>::value || std::is_same_v<T, std::string_view>;
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+struct is_tuple_like : std::false_type {};
+template <typename T, typename U>
+struct is_tuple_like<std::pair<T, U>> : std::true_type {};
+template <typename... Ts>
+struct is_tuple_like<std::tuple<Ts...>> : std::true_type {};
+
+template <typename T>
+concept trivial = std::is_trivially_copyable_v<T> && !view<T>;
+
+template <typename T>
+concept map_like = requires {
+  typename T::key_type;
+  typename T::mapped_type;
+} && requires(T& xs) {
+  xs.size();
+  xs.emplace(std::declval<typename T::key_type>(),
+             std::declval<typename T::mapped_type>());
 };
 
-// non-owned buffer
-struct memory_buffer_base {
-  memory_buffer_base(void* const buffer_) : buffer((char*)buffer_), index(0) {}
-  ~memory_buffer_base() {}
+template <typename T>
+concept reflectable = std::is_aggregate_v<T> && !trivial<T> &&
+                      !is_std_array<T>::value && !std::is_array_v<T> &&
+                      field_count<T> > 0 && field_count<T> <= max_field_count;
 
-  char* const buffer;
-  std::size_t index;
+/** Marks a serialized size that depends on the value. */
+constexpr std::size_t dynamic_size = static_cast<std::size_t>(-1);
 
-  template <typename T,
-            typename = std::enable_if_t<std::is_trivially_copyable<T>::value>>
-  void operator<<(const T& value) {
-    memcpy(buffer + index, &value, sizeof(T));
-    index += sizeof(T);
+template <typename Tuple, std::size_t... Is>
+constexpr std::size_t fixed_size_tuple_(std::index_sequence<Is...>);
+
+/**
+ * The serialized size of each value of type `T`, or `dynamic_size` if it
+ * depends on the value.
+ */
+template <typename T>
+constexpr std::size_t fixed_size() {
+  if constexpr (trivial<T>) {
+    return sizeof(T);
+  } else if constexpr (is_std_array<T>::value) {
+    constexpr auto size = fixed_size<typename T::value_type>();
+    return size == dynamic_size ? dynamic_size
+                                : std::tuple_size_v<T> * size;
+  } else if constexpr (is_tuple_like<T>::value) {
+    return fixed_size_tuple_<T>(
+        std::make_index_sequence<std::tuple_size_v<T>>{});
+  } else if constexpr (reflectable<T>) {
+    using fields_type = decltype(fields(std::declval<T&>()));
+    return fixed_size_tuple_<fields_type>(
+        std::make_index_sequence<std::tuple_size_v<fields_type>>{});
+  } else {
+    return dynamic_size;
   }
+}
 
-  template <typename T,
-            typename = std::enable_if_t<std::is_trivially_copyable<T>::value>>
-  void operator>>(T& value) {
-    memcpy(&value, buffer + index, sizeof(T));
-    index += sizeof(T);
+template <typename Tuple, std::size_t... Is>
+constexpr std::size_t fixed_size_tuple_(std::index_sequence<Is...>) {
+  constexpr std::size_t sizes[] = {
+      fixed_size<std::remove_cvref_t<std::tuple_element_t<Is, Tuple>>>()...,
+      0};
+  std::size_t total = 0;
+  for (auto size : sizes) {
+    if (size == dynamic_size) {
+      return dynamic_size;
+    }
+    total += size;
+  }
+  return total;
+}
+
+template <typename Tuple, std::size_t... Is>
+constexpr bool serializable_tuple_(std::index_sequence<Is...>);
+
+/** Whether values of type `T` can be serialized. */
+template <typename T>
+constexpr bool serializable() {
+  if constexpr (trivial<T> || std::is_same_v<T, std::string> ||
+                std::is_same_v<T, std::string_view>) {
+    return true;
+  } else if constexpr (is_vector<T>::value || is_span<T>::value ||
+                       is_std_array<T>::value || is_optional<T>::value) {
+    return serializable<typename T::value_type>();
+  } else if constexpr (map_like<T>) {
+    return serializable<typename T::key_type>() &&
+           serializable<typename T::mapped_type>();
+  } else if constexpr (is_tuple_like<T>::value) {
+    return serializable_tuple_<T>(
+        std::make_index_sequence<std::tuple_size_v<T>>{});
+  } else if constexpr (reflectable<T>) {
+    using fields_type = decltype(fields(std::declval<T&>()));
+    return serializable_tuple_<fields_type>(
+        std::make_index_sequence<std::tuple_size_v<fields_type>>{});
+  } else {
+    return false;
   }
+}
+
+template <typename Tuple, std::size_t... Is>
+constexpr bool serializable_tuple_(std::index_sequence<Is...>) {
+  return (
+      serializable<std::remove_cvref_t<std::tuple_element_t<Is, Tuple>>>() &&
+      ...);
+}
 
-  void operator<<(const std::string& str) {
-    memcpy(&buffer[index], str.data(), str.length());
-    index += str.length();
-    buffer[index++] = '\0';
+// Apply `f` to each element of a tuple(-like) `xs`, or each field of an
+// aggregate
+template <typename T, typename Func>
+void for_each_field_(T& xs, Func f) {
+  if constexpr (is_tuple_like<std::remove_cv_t<T>>::value) {
+    std::apply([&](auto&... x) { (f(x), ...); }, xs);
+  } else {
+    std::apply([&](auto&... x) { (f(x), ...); }, fields(xs));
   }
+}
+
+// The type of the serialized elements of a container
+template <typename T>
+struct element_type_ {
+  using type = typename T::value_type;
+};
+
+template <map_like T>
+struct element_type_<T> {
+  using type = std::pair<typename T::key_type, typename T::mapped_type>;
+};
 
-  void operator>>(std::string& str) {
-    str = std::string(buffer + index);
-    index += (str.size() + 1) * sizeof(char);
+struct scale {
+  std::size_t size = 0;
+
+  template <typename T>
+  void operator|(const T& value) {
+    constexpr auto fixed = fixed_size<T>();
+    if constexpr (fixed != dynamic_size) {
+      size += fixed;
+    } else if constexpr (std::is_same_v<T, std::string> ||
+                         std::is_same_v<T, std::string_view>) {
+      size += (value.size() + 1) * sizeof(char);
+    } else if constexpr (is_vector<T>::value || is_span<T>::value ||
+                         map_like<T>) {
+      using U = typename element_type_<T>::type;
+      size += sizeof(int);
+      if constexpr (fixed_size<U>() != dynamic_size) {
+        size += value.size() * fixed_size<U>();
+      } else {
+        for (auto& x : value) {
+          (*this) | x;
+        }
+      }
+    } else if constexpr (is_optional<T>::value) {
+      size += sizeof(bool);
+      if (value) {
+        (*this) | *value;
+      }
+    } else if constexpr (is_std_array<T>::value) {
+      for (auto& x : value) {
+        (*this) | x;
+      }
+    } else {
+      for_each_field_(value, [&](auto& x) { (*this) | x; });
+    }
   }
+};
+
+// non-owned buffer
+struct memory_buffer_base {
+  memory_buffer_base(void* const buffer_) : buffer((char*)buffer_), index(0) {}
+  ~memory_buffer_base() {}
+
+  char* const buffer;
+  std::size_t index;
 
   template <typename T>
-  void operator<<(const std::vector<T>& xs) {
-    (*this) << (int)xs.size();
-    memcpy(&buffer[index], &xs[0], xs.size() * sizeof(T));
-    index += xs.size() * sizeof(T);
+  void operator<<(const T& value) {
+    static_assert(serializable<T>(), "Type is not supported for serialization");
+    if constexpr (trivial<T>) {
+      memcpy(buffer + index, &value, sizeof(T));
+      index += sizeof(T);
+    } else if constexpr (std::is_same_v<T, std::string> ||
+                         std::is_same_v<T, std::string_view>) {
+      memcpy(&buffer[index], value.data(), value.length());
+      index += value.length();
+      buffer[index++] = '\0';
+    } else if constexpr (is_vector<T>::value || is_span<T>::value) {
+      using U = typename T::value_type;
+      (*this) << (int)value.size();
+      if constexpr (trivial<U> && !std::is_same_v<U, bool>) {
+        memcpy(&buffer[index], value.data(), value.size() * sizeof(U));
+        index += value.size() * sizeof(U);
+      } else {
+        for (const U& x : value) {
+          (*this) << x;
+        }
+      }
+    } else if constexpr (map_like<T>) {
+      (*this) << (int)value.size();
+      for (auto& [key, x] : value) {
+        (*this) << key;
+        (*this) << x;
+      }
+    } else if constexpr (is_optional<T>::value) {
+      (*this) << value.has_value();
+      if (value) {
+        (*this) << *value;
+      }
+    } else if constexpr (is_std_array<T>::value) {
+      for (auto& x : value) {
+        (*this) << x;
+      }
+    } else {
+      for_each_field_(value, [&](auto& x) { (*this) << x; });
+    }
   }
 
   template <typename T>
-  void operator>>(std::vector<T>& xs) {
-    int size = 0;
-    (*this) >> size;
-    xs.resize(size);
-    memcpy(xs.data(), buffer + index, sizeof(T) * size);
-    index += size * sizeof(T);
+  void operator>>(T& value) {
+    static_assert(serializable<T>(), "Type is not supported for serialization");
+    static_assert(!view<T>, "Views can only be received by a `bulk::queue`");
+    if constexpr (trivial<T>) {
+      memcpy(&value, buffer + index, sizeof(T));
+      index += sizeof(T);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      value = std::string(buffer + index);
+      index += (value.size() + 1) * sizeof(char);
+    } else if constexpr (is_vector<T>::value) {
+      using U = typename T::value_type;
+      int size = 0;
+      (*this) >> size;
+      value.resize(size);
+      if constexpr (trivial<U> && !std::is_same_v<U, bool>) {
+        memcpy(value.data(), buffer + index, sizeof(U) * size);
+        index += size * sizeof(U);
+      } else {
+        for (int i = 0; i < size; ++i) {
+          U x{};
+          (*this) >> x;
+          value[i] = std::move(x);
+        }
+      }
+    } else if constexpr (map_like<T>) {
+      int size = 0;
+      (*this) >> size;
+      value.clear();
+      for (int i = 0; i < size; ++i) {
+        auto key = typename T::key_type{};
+        auto x = typename T::mapped_type{};
+        (*this) >> key;
+        (*this) >> x;
+        value.emplace(std::move(key), std::move(x));
+      }
+    } else if constexpr (is_optional<T>::value) {
+      bool has_value = false;
+      (*this) >> has_value;
+      value.reset();
+      if (has_value) {
+        (*this) >> value.emplace();
+      }
+    } else if constexpr (is_std_array<T>::value) {
+      for (auto& x : value) {
+        (*this) >> x;
+      }
+    } else {
+      for_each_field_(value, [&](auto& x) { (*this) >> x; });
+    }
   }
 };
 
@@ -79,11 +466,6 @@ struct memory_buffer_base {
 struct memory_buffer : public memory_buffer_base {
   memory_buffer(std::size_t size) : memory_buffer_base(new char[size]) {}
   ~memory_buffer() { delete[] buffer; }
-
-  memory_buffer(std::size_t size, char* data)
-      : memory_buffer_base(new char[size]) {
-    memcpy(buffer, data, size);
-  }
 };
 
 struct omembuf {
@@ -97,6 +479,39 @@ struct omembuf {
   memory_buffer_base& membuf;
 };
 
+// Reads like `omembuf`, but copies the content of views into `storage` and
+// points them there
+struct arena_omembuf {
+  arena_omembuf(memory_buffer_base& membuf_, arena& storage_)
+      : membuf(membuf_), storage(storage_) {}
+
+  template <typename T>
+  void operator|(T& rhs) {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      auto size = strlen(membuf.buffer + membuf.index);
+      auto chars = storage.allocate<char>(size + 1);
+      memcpy(chars, membuf.buffer + membuf.index, size + 1);
+      membuf.index += size + 1;
+      rhs = std::string_view(chars, size);
+    } else if constexpr (is_span<T>::value) {
+      using U = typename T::value_type;
+      static_assert(trivial<U>,
+                    "Only spans of trivially copyable types can be received");
+      int size = 0;
+      membuf >> size;
+      auto xs = storage.allocate<U>(size);
+      memcpy(xs, membuf.buffer + membuf.index, size * sizeof(U));
+      membuf.index += size * sizeof(U);
+      rhs = T(xs, size);
+    } else {
+      membuf >> rhs;
+    }
+  }
+
+  memory_buffer_base& membuf;
+  arena& storage;
+};
+
 struct imembuf {
   imembuf(memory_buffer_base& membuf_) : membuf(membuf_) {}
 
@@ -128,4 +543,19 @@ void fill_tuple_(Buffer& buf, Tuple& xs, std::index_sequence<Is...>) {
   fill(buf, std::get<Is>(xs)...);
 }
 
+/**
+ * The total serialized size of `xs`. If the sizes of all types are fixed,
+ * this is a constant and the values are not inspected.
+ */
+template <typename... Ts>
+std::size_t serialized_size(const Ts&... xs) {
+  if constexpr (((fixed_size<Ts>() != dynamic_size) && ...)) {
+    return (fixed_size<Ts>() + ... + 0);
+  } else {
+    scale ruler;
+    ((ruler | xs), ...);
+    return ruler.size;
+  }
+}
+
 }  // namespace bulk::detail
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "indices.hpp"
+
+/**
+ * \file sfc.hpp
+ *
+ * This header provides the keys of indices along the Morton (Z-order) and
+ * Hilbert space-filling curves.
+ */
+
+namespace bulk::util {
+
+/**
+ * Deposit the low bits of `x` at the positions of the set bits of `mask`.
+ *
+ * This is a single `pdep` instruction if BMI2 is enabled (e.g. with `-mbmi2`
+ * or `-march=native`), and a loop without branches over the bits of `mask`
+ * otherwise.
+ */
+inline std::uint64_t deposit_bits(std::uint64_t x, std::uint64_t mask) {
+#if defined(__BMI2__)
+  return _pdep_u64(x, mask);
+#else
+  std::uint64_t result = 0;
+  for (; x != 0 && mask != 0; x >>= 1) {
+    result |= mask & -mask & (std::uint64_t{0} - (x & 1));
+    mask &= mask - 1;
+  }
+  return result;
+#endif
+}
+
+/**
+ * Extract the bits of `x` at the positions of the set bits of `mask`, into
+ * the low bits of the result. The inverse of `deposit_bits`.
+ */
+inline std::uint64_t extract_bits(std::uint64_t x, std::uint64_t mask) {
+#if defined(__BMI2__)
+  return _pext_u64(x, mask);
+#else
+  std::uint64_t result = 0;
+  for (std::uint64_t bit = 1; (x & mask) != 0; bit <<= 1) {
+    result |= bit & (std::uint64_t{0} - ((x & mask & -mask) != 0));
+    mask &= mask - 1;
+  }
+  return result;
+#endif
+}
+
+namespace detail {
+
+// The bits of a `D`-dimensional key that belong to each axis
+template <int D>
+constexpr std::array<std::uint64_t, D> axis_masks_() {
+  std::array<std::uint64_t, D> masks = {};
+  for (int i = 0; i < 64; ++i) {
+    masks[i % D] |= std::uint64_t{1} << i;
+  }
+  return masks;
+}
+
+template <int D>
+inline constexpr auto axis_mask_ = axis_masks_<D>();
+
+// A step of the Hilbert transform of Skilling: if bit `q` of `x` is set, the
+// bits `p` of `x0` are inverted, otherwise they are exchanged with those of
+// `x`. This is written without branches, since the bits are unpredictable.
+inline void rotate_(size_t& x0, size_t& x, size_t q, size_t p) {
+  auto invert = p & (size_t{0} - ((x & q) != 0));
+  auto t = (x0 ^ x) & p & ~invert;
+  x ^= t;
+  x0 ^= t ^ invert;
+}
+
+}  // namespace detail
+
+/**
+ * The key of `xs` along the Morton curve, which interleaves the bits of the
+ * indices with those of axis 0 least significant. Requires each index to be
+ * less than `2^(64 / D)`.
+ */
+template <int D>
+std::uint64_t morton_encode(index_type<D> xs) {
+  std::uint64_t key = 0;
+  for (int d = 0; d < D; ++d) {
+    key |= deposit_bits(xs[d], detail::axis_mask_<D>[d]);
+  }
+  return key;
+}
+
+/** The index with Morton key `key`. */
+template <int D>
+index_type<D> morton_decode(std::uint64_t key) {
+  index_type<D> xs = {};
+  for (int d = 0; d < D; ++d) {
+    xs[d] = extract_bits(key, detail::axis_mask_<D>[d]);
+  }
+  return xs;
+}
+
+/**
+ * The key of `xs` along the Hilbert curve through the cube with side
+ * `2^bits`, using the algorithm of J. Skilling, "Programming the Hilbert
+ * curve" (2004). Consecutive keys belong to neighbouring indices, and the
+ * keys with a common prefix of `D * l` bits form a cube with side
+ * `2^(bits - l)`. Requires `D * bits <= 64`.
+ */
+template <int D>
+std::uint64_t hilbert_encode(index_type<D> xs, int bits) {
+  assert(D * bits <= 64);
+  if constexpr (D == 1) {
+    return xs[0];
+  } else {
+    if (bits == 0) {
+      return 0;
+    }
+    // Undo the rotations and reflections of the subcubes
+    for (size_t q = size_t{1} << (bits - 1); q > 1; q >>= 1) {
+      auto p = q - 1;
+      for (int i = 0; i < D; ++i) {
+        detail::rotate_(xs[0], xs[i], q, p);
+      }
+    }
+    // Gray encode
+    for (int i = 1; i < D; ++i) {
+      xs[i] ^= xs[i - 1];
+    }
+    size_t t = 0;
+    for (size_t q = size_t{1} << (bits - 1); q > 1; q >>= 1) {
+      t ^= (q - 1) & (size_t{0} - ((xs[D - 1] & q) != 0));
+    }
+    // Interleave the transposed key, with axis 0 most significant
+    std::uint64_t key = 0;
+    for (int i = 0; i < D; ++i) {
+      key |= deposit_bits(xs[i] ^ t, detail::axis_mask_<D>[D - 1 - i]);
+    }
+    return key;
+  }
+}
+
+/** The index with Hilbert key `key`, see `hilbert_encode`. */
+template <int D>
+index_type<D> hilbert_decode(std::uint64_t key, int bits) {
+  assert(D * bits <= 64);
+  index_type<D> xs = {};
+  if constexpr (D == 1) {
+    xs[0] = key;
+  } else {
+    for (int i = 0; i < D; ++i) {
+      xs[i] = extract_bits(key, detail::axis_mask_<D>[D - 1 - i]);
+    }
+    // Gray decode
+    auto t = xs[D - 1] >> 1;
+    for (int i = D - 1; i > 0; --i) {
+      xs[i] ^= xs[i - 1];
+    }
+    xs[0] ^= t;
+    // Redo the rotations and reflections of the subcubes
+    for (size_t q = 2; q < (size_t{1} << bits); q <<= 1) {
+      auto p = q - 1;
+      for (int i = D - 1; i >= 0; --i) {
+        detail::rotate_(xs[0], xs[i], q, p);
+      }
+    }
+  }
+  return xs;
+}
+
+}  // namespace bulk::util
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#include "indices.hpp"
+
+/**
+ * \file slice.hpp
+ *
+ * This header provides multi-dimensional slices of flat arrays, and the
+ * layout with which the backends communicate them.
+ */
+
+namespace bulk {
+
+namespace detail {
+
+/**
+ * A block of elements within a flat array. Element `(i_0, ..., i_{r-1})` of
+ * the block is at index `offset + i_0 * strides[0] + ... + i_{r-1} *
+ * strides[r-1]` of the array. The block is trivially copyable, so that
+ * backends can send it along with its elements.
+ */
+struct block_layout {
+  static constexpr int max_rank = 4;
+
+  int rank = 1;
+  size_t offset = 0;
+  size_t extent[max_rank] = {};
+  size_t strides[max_rank] = {};
+
+  /** A block of `count` elements that are `stride` apart. */
+  static block_layout strided(size_t offset, size_t stride, size_t count) {
+    auto layout = block_layout{};
+    layout.offset = offset;
+    layout.extent[0] = count;
+    layout.strides[0] = stride;
+    return layout;
+  }
+
+  /** The layout of the elements of `other`, when packed contiguously. */
+  static block_layout packed(const block_layout& other) {
+    auto layout = block_layout{};
+    layout.rank = other.rank;
+    size_t stride = 1;
+    for (int d = 0; d < other.rank; ++d) {
+      layout.extent[d] = other.extent[d];
+      layout.strides[d] = stride;
+      stride *= other.extent[d];
+    }
+    return layout;
+  }
+
+  /** The number of elements in the block. */
+  size_t count() const {
+    size_t result = 1;
+    for (int d = 0; d < rank; ++d) {
+      result *= extent[d];
+    }
+    return result;
+  }
+
+  /** One past the largest index of an element in the block. */
+  size_t end() const {
+    if (count() == 0) {
+      return offset;
+    }
+    auto last = offset;
+    for (int d = 0; d < rank; ++d) {
+      last += (extent[d] - 1) * strides[d];
+    }
+    return last + 1;
+  }
+};
+
+/**
+ * Call `f(i, j)` with the index of the first element of each row, i.e. line
+ * along the first axis, of two blocks with equal extents.
+ */
+template <typename Func>
+void for_each_row(const block_layout& a, const block_layout& b, Func f) {
+  if (a.count() == 0) {
+    return;
+  }
+  size_t counter[block_layout::max_rank] = {};
+  auto i = a.offset;
+  auto j = b.offset;
+  while (true) {
+    f(i, j);
+    int d = 1;
+    for (; d < a.rank; ++d) {
+      i += a.strides[d];
+      j += b.strides[d];
+      if (++counter[d] < a.extent[d]) {
+        break;
+      }
+      i -= counter[d] * a.strides[d];
+      j -= counter[d] * b.strides[d];
+      counter[d] = 0;
+    }
+    if (d >= a.rank) {
+      return;
+    }
+  }
+}
+
+/**
+ * Copy the elements of size `size` in block `from` of `src` to the block
+ * `to` of `dst`, which has the same extents.
+ */
+inline void copy_block(const char* src, const block_layout& from, char* dst,
+                       const block_layout& to, size_t size) {
+  auto n = from.extent[0];
+  auto s = from.strides[0] * size;
+  auto t = to.strides[0] * size;
+  for_each_row(from, to, [&](size_t i, size_t j) {
+    auto x = src + i * size;
+    auto y = dst + j * size;
+    if (s == size && t == size) {
+      memcpy(y, x, n * size);
+    } else {
+      for (size_t k = 0; k < n; ++k) {
+        memcpy(y + k * t, x + k * s, size);
+      }
+    }
+  });
+}
+
+}  // namespace detail
+
+/**
+ * A `D`-dimensional block of a flat array, e.g. the local image of a coarray
+ * that holds a multi-dimensional array.
+ *
+ * Element `i` of the slice is the element `origin + i` of the array, where
+ * a multi-index `x` is at index `x[0] * strides[0] + ... + x[D-1] *
+ * strides[D-1]` of the flat array.
+ */
+template <int D>
+struct nd_slice {
+  static_assert(D <= detail::block_layout::max_rank,
+                "Slices support at most `block_layout::max_rank` dimensions");
+
+  /** The multi-index of the first element of the slice. */
+  index_type<D> origin;
+  /** The number of elements of the slice along each axis. */
+  index_type<D> extent;
+  /** The distance between consecutive elements of the array along each
+   * axis. */
+  index_type<D> strides;
+
+  /**
+   * The slice of an array of shape `volume`, flattened as by
+   * `bulk::util::flatten`, i.e. with the first axis contiguous.
+   */
+  static nd_slice in(index_type<D> volume, index_type<D> origin,
+                     index_type<D> extent) {
+    auto strides = index_type<D>{};
+    size_t stride = 1;
+    for (int d = 0; d < D; ++d) {
+      strides[d] = stride;
+      stride *= volume[d];
+    }
+    return {origin, extent, strides};
+  }
+
+  /** The number of elements in the slice. */
+  size_t count() const { return layout().count(); }
+
+  /** The layout of the slice, for the backends. */
+  detail::block_layout layout() const {
+    auto result = detail::block_layout{};
+    result.rank = D;
+    for (int d = 0; d < D; ++d) {
+      result.offset += origin[d] * strides[d];
+      result.extent[d] = extent[d];
+      result.strides[d] = strides[d];
+    }
+    return result;
+  }
+};
+
+}  // namespace bulk
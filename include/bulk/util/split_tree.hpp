@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+#include "binary_tree.hpp"
+#include "indices.hpp"
+
+/**
+ * \file split_tree.hpp
+ *
+ * This header provides a tree of splits of a volume, stored in an array for
+ * fast point location.
+ */
+
+namespace bulk::util {
+
+/**
+ * A tree of splits of a `D`-dimensional volume, stored in level order.
+ *
+ * The children of a node are adjacent, and the nodes of each level are
+ * stored after those of the previous level, so that the first levels share a
+ * few cache lines. For a perfect tree this is the Eytzinger layout, with the
+ * children of node `i` at `2i + 1` and `2i + 2`. A leaf is stored as a node
+ * that sends every index to itself, so that locating an index takes exactly
+ * `depth()` branchless steps.
+ *
+ * The leaves are numbered as the bit pattern of their path, with the choice
+ * at depth `k` in bit `k`, and then renumbered consecutively in that order.
+ * For a perfect tree the two numberings coincide.
+ */
+template <int D>
+class split_tree {
+ public:
+  /**
+   * Flatten `splits`, a tree in which a split `{d, a}` assigns the indices
+   * with `x[d] <= a` to the left subtree, of a volume of shape `size`.
+   */
+  split_tree(index_type<D> size, const binary_tree<split>& splits) {
+    struct item {
+      const binary_tree<split>::node* node;
+      int index;
+      int depth;
+      std::uint64_t path;
+      index_type<D> lower;
+      index_type<D> upper;
+    };
+    struct leaf {
+      int index;
+      std::uint64_t path;
+      index_type<D> lower;
+      index_type<D> upper;
+    };
+
+    auto leaves = std::vector<leaf>{};
+    auto queue = std::deque<item>{{splits.root.get(), 0, 0, 0, {}, size}};
+    nodes_.resize(1);
+    while (!queue.empty()) {
+      auto [node, index, depth, path, lower, upper] = queue.front();
+      queue.pop_front();
+      if (!node) {
+        nodes_[index] = {SIZE_MAX, 0, index};
+        leaves.push_back({index, path, lower, upper});
+        depth_ = std::max(depth_, depth);
+        continue;
+      }
+      assert(depth < 64 && "split trees support a depth of at most 64");
+      auto child = static_cast<int>(nodes_.size());
+      nodes_[index] = {node->value.a, node->value.d, child};
+      nodes_.resize(nodes_.size() + 2);
+
+      auto left_upper = upper;
+      left_upper[node->value.d] = node->value.a + 1;
+      auto right_lower = lower;
+      right_lower[node->value.d] = node->value.a + 1;
+      queue.push_back(
+          {node->left.get(), child, depth + 1, path, lower, left_upper});
+      queue.push_back({node->right.get(), child + 1, depth + 1,
+                       path | (std::uint64_t{1} << depth), right_lower,
+                       upper});
+    }
+
+    std::sort(leaves.begin(), leaves.end(),
+              [](auto& lhs, auto& rhs) { return lhs.path < rhs.path; });
+    owners_.resize(nodes_.size());
+    origins_.resize(leaves.size());
+    extents_.resize(leaves.size());
+    for (auto t = 0u; t < leaves.size(); ++t) {
+      owners_[leaves[t].index] = t;
+      origins_[t] = leaves[t].lower;
+      for (int d = 0; d < D; ++d) {
+        extents_[t][d] = leaves[t].upper[d] - leaves[t].lower[d];
+      }
+    }
+  }
+
+  /** The number of leaves. */
+  int leaves() const { return static_cast<int>(origins_.size()); }
+
+  /** The largest depth of a leaf. */
+  int depth() const { return depth_; }
+
+  /** The leaf that contains the index `xs`. */
+  int find(index_type<D> xs) const {
+    int n = 0;
+    for (int k = 0; k < depth_; ++k) {
+      n = step_(n, xs);
+    }
+    return owners_[n];
+  }
+
+  /**
+   * Find the leaves that contain each of the indices `xs`.
+   *
+   * The indices are located in groups that descend the tree together, so
+   * that the loads of a group overlap.
+   */
+  void find_batch(std::span<const index_type<D>> xs,
+                  std::span<int> leaves) const {
+    assert(leaves.size() >= xs.size());
+    constexpr size_t group = 8;
+    size_t i = 0;
+    for (; i + group <= xs.size(); i += group) {
+      int n[group] = {};
+      for (int k = 0; k < depth_; ++k) {
+        for (size_t j = 0; j < group; ++j) {
+          n[j] = step_(n[j], xs[i + j]);
+        }
+      }
+      for (size_t j = 0; j < group; ++j) {
+        leaves[i + j] = owners_[n[j]];
+      }
+    }
+    for (; i < xs.size(); ++i) {
+      leaves[i] = find(xs[i]);
+    }
+  }
+
+  /** The first index of the volume of leaf `t`. */
+  index_type<D> origin(int t) const { return origins_[t]; }
+
+  /** The shape of the volume of leaf `t`. */
+  index_type<D> extent(int t) const { return extents_[t]; }
+
+ private:
+  struct node {
+    // the largest index along `axis` in the left subtree
+    size_t split;
+    int axis;
+    // the index of the left child, which is followed by the right child
+    int child;
+  };
+
+  int step_(int n, const index_type<D>& xs) const {
+    auto& current = nodes_[n];
+    return current.child + static_cast<int>(xs[current.axis] > current.split);
+  }
+
+  std::vector<node> nodes_;
+  std::vector<int> owners_;
+  std::vector<index_type<D>> origins_;
+  std::vector<index_type<D>> extents_;
+  int depth_ = 0;
+};
+
+}  // namespace bulk::util
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "../variable.hpp"
+#include "../world.hpp"
+
+/**
+ * \file workspace.hpp
+ *
+ * This header provides the scratch space that a world owns for the
+ * collectives of `algorithm.hpp`.
+ */
+
+namespace bulk::detail {
+
+/**
+ * A buffer that is registered with a world, and reused by its collectives.
+ *
+ * Registering a coarray is a collective operation (for the thread backend, it
+ * implies a barrier), so constructing one for every call to e.g.
+ * `bulk::sum` would dominate the cost of the call. Instead, the world owns a
+ * single workspace that only grows (and is registered again) when a larger
+ * collective comes along.
+ */
+class workspace : public workspace_base, var_base {
+ public:
+  /**
+   * Obtain the workspace of `world`, with room for at least `size` bytes.
+   *
+   * This must be called on every processor with the same `size`. The
+   * contents are unspecified if the workspace grows.
+   */
+  static workspace& of(bulk::world& world, std::size_t size) {
+    auto& current = world.workspace_;
+    auto capacity = size;
+    if (current) {
+      auto& ws = static_cast<workspace&>(*current);
+      if (ws.size_ >= size) {
+        return ws;
+      }
+      capacity = std::max(size, 2 * ws.size_);
+      // Unregister the old workspace first, so that its slot is reused
+      current.reset();
+    }
+    current.reset(new workspace(world, capacity));
+    return static_cast<workspace&>(*current);
+  }
+
+  ~workspace() { world_.unregister_variable_(id_); }
+
+  workspace(const workspace&) = delete;
+  void operator=(const workspace&) = delete;
+
+  /** The local image of the workspace, as an array of `T`. */
+  template <typename T>
+  T* data() {
+    return reinterpret_cast<T*>(data_.get());
+  }
+
+  /**
+   * Put `count` values to the workspace of `processor`, starting at the
+   * element with index `offset` of its image as an array of `T`.
+   */
+  template <typename T>
+  void put(int processor, const T* values, std::size_t offset,
+           std::size_t count) {
+    world_.put_(processor, values, sizeof(T), id_, offset, count);
+  }
+
+  // Puts are handled by the backend, as for `bulk::array`
+  void deserialize_put(size_t, char*) override final {}
+  void serialize(void*) override final {}
+  size_t serialized_size() override final { return 0; }
+  std::pair<void*, size_t> location_and_size() override final {
+    return {data_.get(), size_};
+  }
+
+ private:
+  workspace(bulk::world& world, std::size_t size)
+      : world_(world),
+        size_(size),
+        data_(new std::max_align_t[(size + sizeof(std::max_align_t) - 1) /
+                                   sizeof(std::max_align_t)]) {
+    id_ = world_.register_variable_(this);
+  }
+
+  bulk::world& world_;
+  std::size_t size_;
+  std::unique_ptr<std::max_align_t[]> data_;
+  int id_;
+};
+
+}  // namespace bulk::detail
@@ -180,9 +180,7 @@ class var {
         auto target_buffer = world_.put_buffer_(t, id_, sizeof(source));
         memcpy(target_buffer, &source, sizeof(source));
       } else {
-        bulk::detail::scale ruler;
-        bulk::detail::fill(ruler, source);
-        auto size = ruler.size;
+        auto size = bulk::detail::serialized_size(source);
         auto target_buffer = world_.put_buffer_(t, id_, size);
         // use non-owning memory buffer
         auto tbuf = bulk::detail::memory_buffer_base(target_buffer);
@@ -209,9 +207,7 @@ class var {
     }
 
     size_t serialized_size() override final {
-      bulk::detail::scale ruler;
-      bulk::detail::fill(ruler, value_);
-      return ruler.size;
+      return bulk::detail::serialized_size(value_);
     }
 
     void serialize(void* buffer) override final {
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <string>
 
+#include "util/reduce.hpp"
+#include "util/slice.hpp"
+
 /**
  * \file world.hpp
  *
@@ -11,6 +15,16 @@
 
 namespace bulk {
 
+namespace detail {
+struct collectives;
+class workspace;
+
+// The scratch space of the collectives, see `util/workspace.hpp`
+struct workspace_base {
+  virtual ~workspace_base() = default;
+};
+}  // namespace detail
+
 /**
  * This objects represents the world of a processor and its place within it.
  */
@@ -174,6 +188,19 @@ class world {
   template <typename... Ts>
   friend class queue;
 
+  template <typename... Ts>
+  friend class soa_queue;
+
+  template <typename Key, typename Value, typename Combine>
+  friend class combining_queue;
+
+  template <typename Key, typename Value, typename Combine, typename Hash,
+            typename Equal>
+  friend class distributed_unordered_map;
+
+  friend struct detail::collectives;
+  friend class detail::workspace;
+
   // Returns the id of the registered location
   virtual int register_variable_(class var_base* location) = 0;
   virtual void unregister_variable_(int id) = 0;
@@ -192,6 +219,62 @@ class world {
   virtual void get_(int processor, int var_id, size_t size, void* target,
                     size_t offset, size_t count) = 0;
 
+  // Strided and indexed puts and gets, in units of elements of `size` bytes.
+  // Element `i` of `values`, at index `i * src_stride`, is put at index
+  // `offset + i * stride` of the remote image, or at `indices[i]`. Element
+  // `i` of `target` is obtained from index `indices[i]`. Backends override
+  // these to send a single record per call. By default, they issue a put or
+  // get per element.
+  virtual void put_strided_(int processor, const void* values, size_t size,
+                            size_t src_stride, int var_id, size_t offset,
+                            size_t stride, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      put_(processor, (const char*)values + i * src_stride * size, size,
+           var_id, offset + i * stride, 1);
+    }
+  }
+
+  virtual void put_indexed_(int processor, const void* values, size_t size,
+                            int var_id, const size_t* indices, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      put_(processor, (const char*)values + i * size, size, var_id, indices[i],
+           1);
+    }
+  }
+
+  virtual void get_indexed_(int processor, int var_id, size_t size,
+                            void* target, const size_t* indices,
+                            size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      get_(processor, var_id, size, (char*)target + i * size, indices[i], 1);
+    }
+  }
+
+  // Put the block `src` of `values` into the block `dst` of the remote image,
+  // which has the same extents. By default, this issues a strided put per
+  // row of the block.
+  virtual void put_block_(int processor, const void* values, size_t size,
+                          const detail::block_layout& src, int var_id,
+                          const detail::block_layout& dst) {
+    detail::for_each_row(src, dst, [&](size_t i, size_t j) {
+      put_strided_(processor, (const char*)values + i * size, size,
+                   src.strides[0], var_id, j, dst.strides[0], src.extent[0]);
+    });
+  }
+
+  // Get the block `src` of the remote image, packed into `target`. By
+  // default, this issues a get per element.
+  virtual void get_block_(int processor, int var_id, size_t size, void* target,
+                          const detail::block_layout& src) {
+    auto packed = detail::block_layout::packed(src);
+    detail::for_each_row(src, packed, [&](size_t i, size_t j) {
+      for (size_t k = 0; k < src.extent[0]; ++k) {
+        get_(processor, var_id, size, (char*)target + (j + k) * size,
+             i + k * src.strides[0], 1);
+      }
+    });
+  }
+
   virtual int register_queue_(class queue_base* q) = 0;
   virtual void unregister_queue_(int id) = 0;
 
@@ -199,6 +282,40 @@ class world {
   virtual char* send_buffer_(int target, int queue_id, size_t buffer_size) = 0;
 
   virtual void log_(std::string message) = 0;
+
+  // Collectives. Backends can override these with a native implementation,
+  // in which case they return true. By default they return false, and the
+  // generic implementation of `algorithm.hpp`, built on puts and syncs, is
+  // used instead. Like the generic implementation, a native collective ends
+  // the current superstep, i.e. it resolves outstanding communication.
+
+  // Reduce `count` elements at `values` element-wise over all processors, in
+  // place.
+  virtual bool allreduce_(void* /* values */, size_t /* count */,
+                          scalar_type /* type */, reduce_op /* op */) {
+    return false;
+  }
+
+  // Copy the `size` bytes at `values` on `root` to `values` on all
+  // processors.
+  virtual bool broadcast_(void* /* values */, size_t /* size */,
+                          int /* root */) {
+    return false;
+  }
+
+  // Gather the `size` bytes at `value` of each processor `t` at
+  // `result + t * size`.
+  virtual bool allgather_(const void* /* value */, void* /* result */,
+                          size_t /* size */) {
+    return false;
+  }
+
+  // Release the scratch space of the collectives. Since it is registered with
+  // the world, backends have to call this in their destructor.
+  void release_workspace_() { workspace_.reset(); }
+
+ private:
+  std::unique_ptr<detail::workspace_base> workspace_;
 };
 
 }  // namespace bulk
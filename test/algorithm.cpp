@@ -1,6 +1,9 @@
 #include <bulk/bulk.hpp>
 #include <chrono>
 #include <limits>
+#include <numeric>
+#include <random>
+#include <ranges>
 #include <thread>
 
 #include "bulk_test_common.hpp"
@@ -45,6 +48,9 @@ void test_algorithm() {
       BULK_CHECK(f1[0] == p * (p + 1) / 2 && f1[1] == (p - 1) * p / 2,
                  "foldl_each");
 
+      auto f3 = bulk::foldl_each(xs, std::plus<int>{}, 10);
+      BULK_CHECK(f3[0] == 10 + p * (p + 1) / 2, "foldl_each with operator");
+
       bulk::coarray<int> zs(world, s, s + 1);
 
       auto f2 = bulk::foldl_each(zs, [](auto& lhs, auto& rhs) { lhs += rhs; });
@@ -52,6 +58,100 @@ void test_algorithm() {
       BULK_CHECK(f2.empty(), "calling foldl_each with non-constant size");
     }
 
+    BULK_SECTION("allreduce") {
+      auto n = 1'000;
+      bulk::coarray<float> xs(world, n);
+      for (auto i = 0; i < n; ++i) {
+        xs[i] = (float)(s + i);
+      }
+      bulk::allreduce(xs, std::plus<float>{});
+      auto expected = [&](int i) { return (float)(p * i + p * (p - 1) / 2); };
+      BULK_CHECK(xs[0] == expected(0) && xs[n - 1] == expected(n - 1),
+                 "allreduce a coarray with a standard operator");
+
+      auto ys = std::vector<int>{s, -s};
+      bulk::allreduce(world, std::span(ys),
+                      [](auto& lhs, auto rhs) { lhs = std::max(lhs, rhs); });
+      BULK_CHECK(ys[0] == p - 1 && ys[1] == 0,
+                 "allreduce a span with a folding function");
+
+      bulk::coarray<int> zs(world, 2 * p + 1, 1);
+      auto block = bulk::reduce_scatter(zs, std::plus<int>{});
+      BULK_CHECK(std::ranges::all_of(block, [&](int x) { return x == p; }),
+                 "reduce-scatter a coarray");
+      BULK_CHECK(bulk::sum(world, block.size()) == 2 * (size_t)p + 1,
+                 "reduce-scatter covers the coarray");
+
+      auto reused = true;
+      for (auto n = 1; n < 2000; n *= 3) {
+        auto ws = std::vector<int>(n, s);
+        bulk::allreduce(world, std::span(ws),
+                        [](auto& lhs, auto rhs) { lhs += rhs; });
+        reused = reused && ws[n - 1] == p * (p - 1) / 2 &&
+                 bulk::gather_all(world, n)[p - 1] == n;
+      }
+      BULK_CHECK(reused, "repeated collectives of growing size");
+    }
+
+    BULK_SECTION("broadcast") {
+      bulk::coarray<int> xs(world, 3, s);
+      bulk::broadcast(xs, p - 1);
+      BULK_CHECK(xs[0] == p - 1 && xs[2] == p - 1, "broadcast small coarray");
+
+      auto n = 10'000;
+      bulk::coarray<int> ys(world, n, 0);
+      if (s == 1) {
+        std::iota(ys.begin(), ys.end(), 0);
+      }
+      bulk::broadcast(ys, 1);
+      BULK_CHECK(std::equal(ys.begin(), ys.end(),
+                            std::views::iota(0, n).begin()),
+                 "broadcast large coarray");
+
+      auto zs = std::vector<double>(n, s == 0 ? 1.5 : 0.0);
+      bulk::broadcast(world, std::span(zs), 0);
+      BULK_CHECK(zs[0] == 1.5 && zs[n - 1] == 1.5, "broadcast a span");
+    }
+
+    BULK_SECTION("broadcast and gather without native collectives") {
+      // The backends provide native collectives, so the generic algorithms
+      // are called directly
+      bulk::coarray<int> xs(world, 3, s);
+      bulk::detail::broadcast_coarray_(xs, p - 1);
+      auto tree_ok = xs[0] == p - 1 && xs[2] == p - 1;
+      BULK_CHECK(tree_ok, "broadcast small coarray along tree");
+
+      auto n = 10'000;
+      bulk::coarray<int> ys(world, n, 0);
+      if (s == 1) {
+        std::iota(ys.begin(), ys.end(), 0);
+      }
+      bulk::detail::broadcast_coarray_(ys, 1);
+      auto scatter_ok =
+          std::equal(ys.begin(), ys.end(), std::views::iota(0, n).begin());
+      BULK_CHECK(scatter_ok,
+                 "broadcast large coarray by scatter and all-gather");
+
+      auto small = std::vector<double>(3, s == p - 1 ? 2.5 : 0.0);
+      bulk::detail::broadcast_span_(world, std::span(small), p - 1);
+      auto large = std::vector<int>(n, 0);
+      if (s == 0) {
+        std::iota(large.begin(), large.end(), 0);
+      }
+      bulk::detail::broadcast_span_(world, std::span(large), 0);
+      auto spans_ok = small[0] == 2.5 && small[2] == 2.5 &&
+                      std::equal(large.begin(), large.end(),
+                                 std::views::iota(0, n).begin());
+      BULK_CHECK(spans_ok, "broadcast small and large spans");
+
+      auto gathered = bulk::detail::gather_all_(world, 10 * s);
+      auto gathered_ok = gathered.size() == (size_t)p;
+      for (int t = 0; t < p && gathered_ok; ++t) {
+        gathered_ok = gathered[t] == 10 * t;
+      }
+      BULK_CHECK(gathered_ok, "gather values by puts to every processor");
+    }
+
     BULK_SECTION("fold aliases") {
       BULK_CHECK(bulk::max(world, s + 1) == p, "max of local values");
       BULK_CHECK(bulk::min(world, s + 1) == 1, "min of local values");
@@ -84,6 +184,127 @@ void test_algorithm() {
               s == 0 ? (int64_t)std::numeric_limits<int32_t>::max() + 1 : 1) ==
               (int64_t)std::numeric_limits<int32_t>::max() + 1,
           "large product");
+
+      BULK_CHECK(bulk::max(world, -1.0 - s) == -1.0,
+                 "max of negative floating point values");
+      auto ys = bulk::coarray<double>(world, 2, -0.5 * s);
+      BULK_CHECK(bulk::max(ys) == 0.0 && bulk::min(ys) == -0.5 * (p - 1),
+                 "max and min of floating point coarray");
+      BULK_CHECK(bulk::max(world, (short)s) == p - 1,
+                 "max of values without native reduction");
+      BULK_CHECK(
+          bulk::max(world, bulk::maximum<>{}(s, 1)) == std::max(p - 1, 1),
+          "maximum operator");
+    }
+
+    BULK_SECTION("sort") {
+      // Whether the parts are sorted, in rank order, and hold `count` values
+      // with sum `sum` in all
+      auto sorted = [&](const auto& xs, auto count, auto sum, auto comp) {
+        auto ok = std::is_sorted(xs.begin(), xs.end(), comp);
+        auto ends = bulk::gather_all(
+            world, std::array<double, 3>{
+                       (double)xs.size(), xs.empty() ? 0.0 : (double)xs[0],
+                       xs.empty() ? 0.0 : (double)xs[xs.size() - 1]});
+        auto seen = false;
+        auto last = 0.0;
+        for (auto [size, first, back] : ends) {
+          if (size > 0) {
+            ok = ok && (!seen || !comp(first, last));
+            seen = true;
+            last = back;
+          }
+        }
+        ok = ok && bulk::sum(world, xs.size()) == count;
+        return ok && bulk::sum(world, std::accumulate(xs.begin(), xs.end(),
+                                                      0.0)) == sum;
+      };
+
+      auto gen = std::mt19937(s);
+      auto n = 1000 + 37 * s;
+      auto xs = std::vector<int>(n);
+      for (auto& x : xs) {
+        x = (int)(gen() % 20000) - 10000;
+      }
+      auto values_sum =
+          bulk::sum(world, std::accumulate(xs.begin(), xs.end(), 0.0));
+      auto count = bulk::sum(world, (size_t)n);
+      auto ys = bulk::sort(world, std::span(xs));
+      auto radix = sorted(ys, count, values_sum, std::less<>{});
+      auto balanced = bulk::max(world, ys.size()) <= 2 * count / p;
+      BULK_CHECK(radix, "sort integers with a radix sort");
+      BULK_CHECK(balanced, "sort into balanced parts");
+
+      auto zs = std::vector<double>(xs.begin(), xs.end());
+      auto descending = bulk::sort(world, std::span(zs), std::greater<>{});
+      auto compared =
+          sorted(descending, count, values_sum, std::greater<>{});
+      BULK_CHECK(compared, "sort with a comparison");
+
+      auto equal = std::vector<int>(n, 7);
+      auto spread = bulk::sort(world, std::span(equal));
+      auto grouped = bulk::sort(world, std::span(equal), std::less<>{},
+                                {.spread_duplicates = false});
+      auto spread_ok = sorted(spread, count, 7.0 * count, std::less<>{}) &&
+                       bulk::max(world, spread.size()) <= 2 * count / p;
+      auto grouped_ok = bulk::max(world, grouped.size()) == count;
+      BULK_CHECK(spread_ok, "sort equal keys into balanced parts");
+      BULK_CHECK(grouped_ok, "sort equal keys onto the same processor");
+
+      auto single = std::span(xs).first(s == 0 ? n : 0);
+      auto single_total = bulk::sum(
+          world, std::accumulate(single.begin(), single.end(), 0.0));
+      auto ws = bulk::sort(world, single);
+      auto single_ok = sorted(ws, size_t{1000}, single_total, std::less<>{});
+      BULK_CHECK(single_ok, "sort the values of a single processor");
+
+      auto co = bulk::coarray<double>(world, n);
+      std::copy(zs.begin(), zs.end(), co.begin());
+      auto co_sorted = bulk::sort(co);
+      auto co_ok =
+          sorted(std::vector<double>(co_sorted.begin(), co_sorted.end()),
+                 count, values_sum, std::less<>{});
+      BULK_CHECK(co_ok, "sort a coarray");
+    }
+
+    BULK_SECTION("map_reduce") {
+      auto inputs = std::vector<int>(100);
+      std::iota(inputs.begin(), inputs.end(), 0);
+      auto map = [s](int x, auto& emit) {
+        emit(x % 10, 1);
+        emit(100 + s, x);
+      };
+      // A small combiner, so that keys are sent more than once
+      auto counts = bulk::map_reduce<int, int>(world, inputs, map, std::plus{},
+                                               {.max_combiner_size = 4});
+
+      // Checks synchronize, so we inspect the pairs first
+      auto counts_ok = true;
+      for (auto [key, value] : counts) {
+        counts_ok = counts_ok && value == (key < 10 ? 10 * p : 4950);
+      }
+      auto entries = bulk::sum(world, counts.size());
+      auto sorted = bulk::gather_sorted(world, counts);
+      auto sorted_ok = s == 0 ? sorted.size() == entries &&
+                                    std::is_sorted(sorted.begin(), sorted.end())
+                              : sorted.empty();
+
+      auto keep_max = [](int& lhs, int rhs) { lhs = std::max(lhs, rhs); };
+      auto maxima = bulk::map_reduce<std::string, int>(
+          world, inputs,
+          [](int x, auto& emit) { emit(x % 2 ? "odd" : "even", x); },
+          keep_max);
+      auto by_value = bulk::gather_sorted(
+          world, maxima, [](const auto& lhs, const auto& rhs) {
+            return lhs.second > rhs.second;
+          });
+      auto maxima_ok =
+          s != 0 || (by_value.size() == 2 && by_value[0].first == "odd" &&
+                     by_value[0].second == 99 && by_value[1].second == 98);
+
+      BULK_CHECK(counts_ok && entries == 10u + p, "map and reduce pairs");
+      BULK_CHECK(sorted_ok, "gather sorted pairs along a tree");
+      BULK_CHECK(maxima_ok, "reduce with a folding function");
     }
   });
 }
@@ -1,5 +1,13 @@
 #include <bulk/bulk.hpp>
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string_view>
 #include <thread>
 
 #include "bulk_test_common.hpp"
@@ -7,6 +15,26 @@
 
 extern environment env;
 
+struct particle {
+  std::string name;
+  std::array<double, 3> position;
+  std::vector<int> neighbours;
+  std::optional<std::map<std::string, int>> labels;
+};
+
+// Aggregates whose fields cannot be decomposed, as they are miscounted
+struct with_builtin_array {
+  std::string name;
+  int xs[3];
+  double d;
+};
+struct with_base : particle {
+  int id;
+};
+static_assert(bulk::detail::decomposable_<particle>);
+static_assert(!bulk::detail::decomposable_<with_builtin_array>);
+static_assert(!bulk::detail::decomposable_<with_base>);
+
 void test_communication() {
   env.spawn(env.available_processors(), [](auto& world) {
     int s = world.rank();
@@ -154,6 +182,18 @@ void test_communication() {
 
       BULK_CHECK(b.value() == "test" + std::to_string(world.next_rank()),
                  "can get a string");
+
+      // gets of different sizes, reusing the buffers of the previous superstep
+      a = std::string(100 * (s + 1), 'a' + s);
+      auto c = a(world.next_rank()).get();
+      auto d = a(world.prev_rank()).get();
+      world.sync();
+
+      auto t = world.next_rank();
+      auto u = world.prev_rank();
+      BULK_CHECK(c.value() == std::string(100 * (t + 1), 'a' + t) &&
+                     d.value() == std::string(100 * (u + 1), 'a' + u),
+                 "can get strings of different sizes");
     }
 
     BULK_SECTION("Put multiple") {
@@ -416,6 +456,78 @@ void test_communication() {
       BULK_CHECK(flag, "getting slices");
     }
 
+    BULK_SECTION("Strided and indexed coarray communication") {
+      // a 4 x 3 column-major matrix on each processor
+      auto xs = bulk::coarray<int>(world, 12, -1);
+      auto ys = bulk::coarray<int>(world, 12, -1);
+      auto local = std::vector<int>(12);
+      std::iota(local.begin(), local.end(), 100 * s);
+
+      // put row 1 of the local matrix into row 2 of the next processor
+      xs.put_strided(world.next_rank(), local.data() + 1, 4, 2, 4, 3);
+      // put the first three values in reverse order at the odd indices
+      auto indices = std::vector<size_t>{5, 3, 1};
+      ys.put_indexed(world.next_rank(), std::span<const int>(local.data(), 3),
+                     indices);
+      world.sync();
+
+      auto t = world.prev_rank();
+      auto strided = xs[2] == 100 * t + 1 && xs[6] == 100 * t + 5 &&
+                     xs[10] == 100 * t + 9 && xs[1] == -1 && xs[3] == -1;
+      auto indexed = ys[5] == 100 * t && ys[3] == 100 * t + 1 &&
+                     ys[1] == 100 * t + 2 && ys[0] == -1 && ys[2] == -1;
+
+      std::copy(local.begin(), local.end(), xs.begin());
+      world.sync();
+      auto gather = std::vector<size_t>{11, 0, 7, 7};
+      auto zs = xs.get_indexed(world.next_rank(), gather);
+      world.sync();
+      auto u = world.next_rank();
+      auto gathered = zs[0] == 100 * u + 11 && zs[1] == 100 * u &&
+                      zs[2] == 100 * u + 7 && zs[3] == 100 * u + 7;
+
+      BULK_CHECK(strided, "put strided values");
+      BULK_CHECK(indexed, "put values at indices");
+      BULK_CHECK(gathered, "get values at indices");
+    }
+
+    BULK_SECTION("Multi-dimensional coarray slices") {
+      // 4 x 5 images, flattened with the first axis contiguous
+      auto xs = bulk::coarray<int>(world, 20, -1);
+      auto local = std::vector<int>(20);
+      std::iota(local.begin(), local.end(), 100 * s);
+      auto at = [](size_t i, size_t j) { return i + 4 * j; };
+
+      // the 2 x 3 block at (1, 1) of `local` goes to (2, 0) of the next image
+      xs.put(world.next_rank(), local.data(),
+             bulk::nd_slice<2>::in({4, 5}, {1, 1}, {2, 3}),
+             bulk::nd_slice<2>::in({4, 5}, {2, 0}, {2, 3}));
+      world.sync();
+
+      auto t = world.prev_rank();
+      auto put_block = true;
+      for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 5; ++j) {
+          auto inside = i >= 2 && j < 3;
+          auto expected = inside ? (int)(100 * t + at(i - 1, j + 1)) : -1;
+          put_block = put_block && xs[at(i, j)] == expected;
+        }
+      }
+
+      std::copy(local.begin(), local.end(), xs.begin());
+      world.sync();
+      // a 3D view of the image: 2 x 2 x 5, and its 1 x 2 x 2 block at (1,0,3)
+      auto ys = xs.get(world.next_rank(),
+                       bulk::nd_slice<3>::in({2, 2, 5}, {1, 0, 3}, {1, 2, 2}));
+      world.sync();
+      auto u = world.next_rank();
+      auto get_block = ys[0] == 100 * u + 13 && ys[1] == 100 * u + 15 &&
+                       ys[2] == 100 * u + 17 && ys[3] == 100 * u + 19;
+
+      BULK_CHECK(put_block, "put a 2D block");
+      BULK_CHECK(get_block, "get a 3D block");
+    }
+
     BULK_SECTION("Single message passing") {
       bulk::queue<int, int> q(world);
       q(world.next_rank()).send(123, 1337);
@@ -511,6 +623,143 @@ void test_communication() {
       BULK_CHECK(q2.empty(), "second queue gets emptied");
     }
 
+    BULK_SECTION("Structure-of-arrays queue") {
+      auto q = bulk::soa_queue<int, float, int[]>(world);
+      for (int i = 0; i < 5; ++i) {
+        q(world.next_rank()).send(i, 0.5f * s, {s, i});
+      }
+      world.sync();
+
+      // Checks synchronize, so we inspect the columns first
+      auto size = q.size();
+      auto tags = q.column<0>();
+      auto tags_ok =
+          std::equal(tags.begin(), tags.end(), std::views::iota(0, 5).begin());
+      auto values_ok = std::ranges::all_of(q.column<1>(), [&](float x) {
+        return x == 0.5f * world.prev_rank();
+      });
+      auto arrays_ok =
+          q.column<2>()[3] == std::vector<int>{world.prev_rank(), 3};
+
+      BULK_CHECK(size == 5, "received every message in columns");
+      BULK_CHECK(tags_ok, "first column holds the first components");
+      BULK_CHECK(values_ok, "second column holds the second components");
+      BULK_CHECK(arrays_ok, "array components are stored in a column");
+
+      world.sync();
+      BULK_CHECK(q.empty() && q.column<1>().empty(),
+                 "columns are emptied by sync");
+    }
+
+    BULK_SECTION("Combining queue") {
+      auto q = bulk::combining_queue<int, int>(world);
+      for (int i = 0; i < 100; ++i) {
+        q(world.next_rank()).send(i % 10, 1);
+        q(world.rank()).send(i % 5, 2);
+      }
+      auto keep_max = [](int& lhs, int rhs) { lhs = std::max(lhs, rhs); };
+      auto words = bulk::combining_queue<std::string, int, decltype(keep_max)>(
+          world, keep_max);
+      words(0).send("bulk", s);
+      words(0).send("sync", -s);
+      world.sync();
+
+      // Checks synchronize, so we inspect the messages first
+      auto size = q.size();
+      auto sum = 0;
+      auto counts_ok = true;
+      for (auto [key, value] : q) {
+        sum += value;
+        counts_ok = counts_ok && value == (key < 5 ? 10 + 40 : 10);
+      }
+      auto maxima_ok = true;
+      for (auto [word, value] : words) {
+        maxima_ok = maxima_ok && value == (word == "bulk" ? p - 1 : 0);
+      }
+      auto words_size = words.size();
+
+      BULK_CHECK(size == 10, "messages with equal keys are combined");
+      BULK_CHECK(sum == 300 && counts_ok, "values are combined");
+      BULK_CHECK(maxima_ok && words_size == (s == 0 ? 2u : 0u),
+                 "combine messages with a folding function");
+    }
+
+    BULK_SECTION("Distributed unordered map") {
+      auto counts = bulk::distributed_unordered_map<std::string, int>(world);
+      for (int i = 0; i < 100; ++i) {
+        counts.combine("key" + std::to_string(i % 10), 1);
+      }
+      counts.insert("first", s);
+      counts.upsert("last", s);
+      auto counted = counts.find("key0");
+      counts.sync();
+
+      // All processors have added to the same keys, and their entries are
+      // stored by their owners
+      auto owned_ok = true;
+      for (auto& [key, value] : counts.local()) {
+        owned_ok = owned_ok && counts.owner(key) == s;
+      }
+      auto local_size = counts.local_size();
+      auto entries = bulk::sum(world, local_size);
+
+      // Lookups are answered after the updates of their own superstep
+      auto keys = std::vector<std::string>{"key3", "first", "none"};
+      auto results = std::vector<std::optional<int>>(keys.size());
+      counts.find(keys, results);
+      auto last = counts.find("last");
+      counts.insert("key3", -1);
+      counts.combine("key3", 1);
+      counts.sync();
+
+      BULK_CHECK(owned_ok && entries == 12u, "entries are partitioned by key");
+      BULK_CHECK(counted.value() == 10 * p, "values are combined");
+      BULK_CHECK(results[0] == 10 * p + p && results[1] && !results[2],
+                 "batched lookups are answered");
+      BULK_CHECK(last.value() && *last.value() >= 0 && *last.value() < p,
+                 "upserts set a value");
+    }
+
+    BULK_SECTION("Messages with aggregates") {
+      auto q = bulk::queue<particle, std::pair<int, std::string>>(world);
+      auto labels = std::map<std::string, int>{{"rank", s}};
+      q(world.next_rank()).send({"a", {1.0, 2.0, 3.0}, {s, s + 1}, labels},
+                                {s, "b"});
+      q(world.next_rank()).send({"c", {}, {}, {}}, {-s, ""});
+      world.sync();
+
+      // Checks synchronize, so we inspect the messages first
+      auto t = world.prev_rank();
+      auto size = q.size();
+      auto first_ok = false;
+      auto second_ok = false;
+      for (auto& [x, pair] : q) {
+        if (x.name == "a") {
+          first_ok = x.position[2] == 3.0 &&
+                     x.neighbours == std::vector<int>{t, t + 1} &&
+                     x.labels && x.labels->at("rank") == t &&
+                     pair == std::pair<int, std::string>{t, "b"};
+        } else {
+          second_ok = x.name == "c" && x.neighbours.empty() && !x.labels &&
+                      pair.first == -t && pair.second.empty();
+        }
+      }
+
+      BULK_CHECK(size == 2, "aggregate messages received");
+      BULK_CHECK(first_ok, "aggregates with nested containers are sent");
+      BULK_CHECK(second_ok, "aggregates with empty members are sent");
+
+      auto x = bulk::var<particle>(world);
+      x(world.next_rank()) = particle{"d", {}, {1, 2, 3}, {}};
+      world.sync();
+      BULK_CHECK(x.value().name == "d" && x.value().neighbours.size() == 3,
+                 "put an aggregate");
+
+      auto y = x(world.prev_rank()).get();
+      world.sync();
+      BULK_CHECK(y.value().neighbours[2] == 3, "get an aggregate");
+    }
+
     BULK_SECTION("Messages with arrays") {
       auto q = bulk::queue<int[]>(world);
       q(world.next_rank()).send({1, 2, 3, 4});
@@ -522,6 +771,67 @@ void test_communication() {
       }
     }
 
+    BULK_SECTION("Messages from spans and written in place") {
+      auto xs = std::vector<int>{1, 2, 3, 4, 5, 6};
+      auto q = bulk::queue<int[]>(world);
+      q(world.next_rank()).send(std::span<const int>(xs).subspan(1, 3));
+      q(world.next_rank()).send_with(2, [&](std::span<std::byte> bytes) {
+        memcpy(bytes.data(), xs.data() + 4, bytes.size());
+      });
+      q(world.next_rank()).send_with(0, [](std::span<std::byte>) {});
+
+      auto r = bulk::queue<int, double[]>(world);
+      auto ys = std::array<double, 2>{0.5, 1.5};
+      r(world.next_rank()).send(s, std::span<const double>(ys));
+      world.sync();
+
+      auto received = std::vector<std::vector<int>>(q.begin(), q.end());
+      std::sort(received.begin(), received.end());
+      auto expected = std::vector<std::vector<int>>{{}, {2, 3, 4}, {5, 6}};
+      auto tagged = r.size() == 1;
+      for (auto [tag, values] : r) {
+        tagged = tagged && tag == world.prev_rank() &&
+                 values == std::vector<double>{0.5, 1.5};
+      }
+      BULK_CHECK(received == expected, "send arrays from spans and in place");
+      BULK_CHECK(tagged, "send a span alongside other components");
+    }
+
+    BULK_SECTION("Messages received as views") {
+      auto q = bulk::queue<std::string_view, std::span<const int>>(world);
+      auto word = std::string(3 + s, 'a' + s);
+      auto xs = std::vector<int>(1000 * (s + 1), s);
+      for (int i = 0; i < 3; ++i) {
+        q(world.next_rank()).send(word, xs);
+      }
+      q(world.next_rank()).send("", {});
+      world.sync();
+
+      // inspect before checking, since a check syncs and clears the queue
+      auto t = world.prev_rank();
+      auto expected_word = std::string(3 + t, 'a' + t);
+      auto count = 0;
+      auto correct = q.size() == 4;
+      for (auto [w, ys] : q) {
+        if (w.empty()) {
+          correct = correct && ys.empty();
+          continue;
+        }
+        correct = correct && w == expected_word &&
+                  ys.size() == 1000u * (t + 1) &&
+                  std::ranges::all_of(ys, [t](int y) { return y == t; });
+        ++count;
+      }
+
+      auto r = bulk::queue<std::string_view>(world);
+      r(world.next_rank()).send(word);
+      world.sync();
+      auto again = r.size() == 1 && *r.begin() == expected_word;
+
+      BULK_CHECK(correct && count == 3, "receive strings and spans as views");
+      BULK_CHECK(again, "receive views in a later superstep");
+    }
+
     BULK_SECTION("Messages with multiple arrays") {
       auto q = bulk::queue<int[], float[]>(world);
       q(world.next_rank()).send({1, 2, 3, 4}, {1.0f, 2.0f});
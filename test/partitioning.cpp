@@ -51,6 +51,40 @@ void test_partitioning() {
                  "compute correctly the local index");
     }
 
+    BULK_SECTION("Block-cyclic partitioning") {
+      // Compare with a direct computation of the owners and local indices,
+      // for general block sizes, and for powers of two, which take the fast
+      // path if N is a power of two as well
+      auto agree = [&](bulk::index_type<2> size, bulk::index_type<2> blocks) {
+        auto part = bulk::block_cyclic_partitioning<2>(size, {N, N}, blocks);
+        auto correct = true;
+        auto counts = std::vector<size_t>(p);
+        for (size_t i = 0; i < size[0] * size[1]; ++i) {
+          auto x = bulk::util::unflatten<2>(size, i);
+          auto owner = part.multi_owner(x);
+          auto local = part.local(x);
+          for (int d = 0; d < 2; ++d) {
+            auto block = x[d] / blocks[d];
+            correct = correct && owner[d] == block % N &&
+                      local[d] == block / N * blocks[d] + x[d] % blocks[d];
+          }
+          correct = correct && part.global(local, owner) == x;
+          ++counts[part.rank(owner)];
+        }
+        for (size_t t = 0; t < p; ++t) {
+          correct = correct && counts[t] == part.local_count(t);
+        }
+        return correct;
+      };
+      BULK_CHECK(agree({10, 7}, {2, 3}), "computes block-cyclic indices");
+      BULK_CHECK(agree({16, 9}, {4, 1}),
+                 "computes block-cyclic indices for powers of two");
+
+      auto part = bulk::block_cyclic_partitioning<2, 1>({10, 3}, {p}, {2});
+      BULK_CHECK(part.local_size(1, 0) == 3 && part.owner({2 * p + 1, 2}) == 0,
+                 "partitions only the first axes");
+    }
+
     BULK_SECTION("Block partitioning") {
       auto part = bulk::block_partitioning<2, 2>({10 * N, 10 * N}, {N, N});
       BULK_CHECK(part.multi_owner({2 * 10 + 3, 3})[0] == 2,
@@ -120,6 +154,21 @@ void test_partitioning() {
 
       BULK_CHECK((part.local({6, 6}) == bulk::index<2>{1, 1}),
                  "local computation bspart");
+
+      // A tree that is not perfect, with leaves at depth one and two
+      auto uneven =
+          bulk::util::binary_tree<bulk::util::split>(bulk::util::split{0, 4});
+      uneven.add(uneven.root.get(), dir::right, bulk::util::split{1, 4});
+      auto part3 = bulk::tree_partitioning<2>({10, 10}, 3, std::move(uneven));
+      auto xs = std::vector<bulk::index_type<2>>{{1, 1}, {6, 2}, {6, 7}};
+      auto owners = std::vector<int>(xs.size());
+      part3.owner_batch(xs, owners);
+
+      BULK_CHECK((owners == std::vector<int>{0, 1, 2}),
+                 "numbers the leaves of uneven trees consecutively");
+      BULK_CHECK((part3.origin(2) == bulk::index<2>{5, 5}) &&
+                     (part3.local_size(0) == bulk::index<2>{5, 10}),
+                 "computes volumes of uneven trees");
     }
 
     BULK_SECTION("Partitioned array") {
@@ -145,6 +194,217 @@ void test_partitioning() {
       BULK_CHECK(glob.value() == 1234, "put remote value");
     }
 
+    BULK_SECTION("Partitioned array iteration") {
+      auto block = bulk::block_partitioning<2>({7, 5}, {N, N});
+      auto cyclic = bulk::cyclic_partitioning<3, 2>({7, 5, 2}, {N, N});
+      auto xs = bulk::partitioned_array<size_t, 2>(world, block);
+      auto ys = bulk::partitioned_array<size_t, 3, 2>(world, cyclic);
+
+      xs.for_each([&](auto index, auto& x) {
+        x = bulk::util::flatten<2>(block.global_size(), index);
+      });
+      ys.for_each([&](auto index, auto& y) {
+        y = bulk::util::flatten<3>(cyclic.global_size(), index);
+      });
+
+      auto local = block.local_size(s);
+      auto stored = xs.size() == block.local_count(s) &&
+                    xs.strides()[1] == local[0];
+      for (size_t j = 0; j < local[1]; ++j) {
+        for (size_t i = 0; i < local[0]; ++i) {
+          auto index = block.global({i, j}, s);
+          stored = stored && xs.global_index({i, j}) == index &&
+                   xs.local({i, j}) ==
+                       bulk::util::flatten<2>(block.global_size(), index) &&
+                   &xs.local({i, j}) == xs.data() + i + j * local[0];
+        }
+      }
+      auto cyclic_stored = true;
+      auto cyclic_local = cyclic.local_size(s);
+      for (size_t k = 0; k < cyclic_local[2]; ++k) {
+        for (size_t j = 0; j < cyclic_local[1]; ++j) {
+          for (size_t i = 0; i < cyclic_local[0]; ++i) {
+            auto index = cyclic.global({i, j, k}, s);
+            cyclic_stored =
+                cyclic_stored &&
+                ys.local({i, j, k}) ==
+                    bulk::util::flatten<3>(cyclic.global_size(), index);
+          }
+        }
+      }
+      BULK_CHECK(stored, "iterates with global indices (block)");
+      BULK_CHECK(cyclic_stored, "iterates with global indices (cyclic)");
+
+      auto x = xs.global({6, 4}).get();
+      auto y = ys.global({6, 4, 1}).get();
+      world.sync();
+      BULK_CHECK(x.value() == 6 + 4 * 7, "get remote value (block)");
+      BULK_CHECK(y.value() == 6 + 4 * 7 + 35, "get remote value (cyclic)");
+    }
+
+    BULK_SECTION("Local views") {
+      auto part = bulk::block_partitioning<3, 2>({7, 5, 3}, {N, N});
+      auto xs = bulk::partitioned_array<size_t, 3, 2>(world, part);
+      xs.for_each([&](auto index, auto& x) {
+        x = bulk::util::flatten<3>(part.global_size(), index);
+      });
+
+      auto view = xs.view();
+      auto coview = bulk::local_view<size_t, 3>(xs.storage(), part);
+      auto local = xs.local_size();
+      auto left = view.extents() == local && coview.data() == xs.data() &&
+                  view.size() == xs.size();
+      for (size_t k = 0; k < local[2]; ++k) {
+        for (size_t j = 0; j < local[1]; ++j) {
+          for (size_t i = 0; i < local[0]; ++i) {
+            left = left && &view(i, j, k) == &xs.local({i, j, k}) &&
+                   &coview[{i, j, k}] == &xs.local({i, j, k});
+          }
+        }
+      }
+      BULK_CHECK(left, "views local elements with the first axis contiguous");
+
+      auto row_major = bulk::local_view<const size_t, 3, bulk::layout_right>(
+          xs.data(), local);
+      auto right = row_major.stride(2) == 1 &&
+                   row_major.stride(1) == local[2] &&
+                   row_major.stride(0) == local[1] * local[2];
+      for (size_t k = 0; k < xs.size(); ++k) {
+        auto index = bulk::index_type<3>{k / (local[1] * local[2]),
+                                         k / local[2] % local[1], k % local[2]};
+        right = right && &row_major[index] == xs.data() + k;
+      }
+      BULK_CHECK(right, "views local elements with the last axis contiguous");
+    }
+
+    BULK_SECTION("Static partitionings") {
+      auto size = bulk::index_type<3>{11, 7, 4};
+      auto block = bulk::block_partitioning<3, 2>(size, {3, 2}, {2, 0});
+      auto static_block =
+          bulk::static_block_partitioning<3, 2>(size, {3, 2}, {2, 0});
+      auto cyclic = bulk::cyclic_partitioning<3, 2>(size, {3, 2});
+      auto static_cyclic = bulk::static_cyclic_partitioning<3, 2>(size, {3, 2});
+
+      using dir = bulk::util::binary_tree<bulk::util::split>::dir;
+      auto splits =
+          bulk::util::binary_tree<bulk::util::split>(bulk::util::split{0, 5});
+      auto root = splits.root.get();
+      splits.add(root, dir::left, bulk::util::split{1, 2});
+      splits.add(root, dir::right, bulk::util::split{2, 0});
+      auto static_tree = bulk::static_tree_partitioning<3>(size, 4, splits);
+      auto tree = bulk::tree_partitioning<3>(size, 4, std::move(splits));
+
+      static_assert(bulk::static_partitioning<decltype(static_block)>);
+      static_assert(bulk::static_partitioning<decltype(static_tree)>);
+
+      auto xs = std::vector<bulk::index_type<3>>{};
+      for (size_t i = 0; i < size[0] * size[1] * size[2]; ++i) {
+        xs.push_back(bulk::util::unflatten<3>(size, i));
+      }
+      auto owners = std::vector<int>(xs.size());
+
+      // Check that a static partitioning agrees with its dynamic counterpart
+      auto agree = [&](auto& dynamic, auto& fixed, int procs) {
+        auto correct = true;
+        for (int t = 0; t < procs; ++t) {
+          correct = correct && fixed.local_size(t) == dynamic.local_size(t);
+        }
+        auto batch = fixed.owner_batch(xs, owners);
+        correct = correct && batch.size() == xs.size();
+        for (size_t i = 0; i < xs.size(); ++i) {
+          auto t = dynamic.owner(xs[i]);
+          correct = correct && fixed.owner(xs[i]) == t && batch[i] == t &&
+                    fixed.local(xs[i]) == dynamic.local(xs[i]) &&
+                    fixed.global(fixed.local(xs[i]), t) == xs[i];
+        }
+        return correct;
+      };
+
+      BULK_CHECK(agree(block, static_block, 6), "static block partitioning");
+      BULK_CHECK(agree(cyclic, static_cyclic, 6), "static cyclic partitioning");
+      BULK_CHECK(agree(tree, static_tree, 4), "static tree partitioning");
+
+      // Indices above 2^32, with a block size of 2^32 along the first axis
+      // and of one along the second
+      auto wide_size = bulk::index_type<2>{1ull << 33, 2};
+      auto wide = bulk::block_partitioning<2>(wide_size, {2, 2});
+      auto static_wide = bulk::static_block_partitioning<2>(wide_size, {2, 2});
+      auto wide_ok = true;
+      for (size_t x : {0ull, 5ull, (1ull << 32) - 1, 1ull << 32,
+                       (1ull << 33) - 1}) {
+        for (size_t y : {0ull, 1ull}) {
+          auto index = bulk::index_type<2>{x, y};
+          wide_ok = wide_ok && static_wide.owner(index) == wide.owner(index) &&
+                    static_wide.local(index) == wide.local(index);
+        }
+      }
+      BULK_CHECK(wide_ok, "static block partitioning of wide indices");
+
+      auto divided = true;
+      for (std::uint32_t d : {1u, 3u, 7u, 1000u, 4294967295u}) {
+        auto divider = bulk::util::divider(d);
+        for (std::uint32_t n : {0u, 1u, 6u, 999u, 1000u, 123456789u,
+                                4294967294u, 4294967295u}) {
+          divided = divided && divider.divide(n) == n / d &&
+                    divider.modulo(n) == n % d;
+        }
+      }
+      BULK_CHECK(divided, "divides by a fixed divisor");
+    }
+
+    BULK_SECTION("Redistribute") {
+      auto size = bulk::index_type<2>{7, 5};
+      // Check that each element holds its flattened global index
+      auto holds_global = [&](auto& xs) {
+        auto correct = true;
+        xs.for_each([&](auto index, auto x) {
+          correct = correct && x == bulk::util::flatten<2>(size, index);
+        });
+        return correct;
+      };
+
+      auto block = bulk::block_partitioning<2>(size, {N, N});
+      auto cyclic = bulk::cyclic_partitioning<2>(size, {N, N});
+      auto rows = bulk::block_partitioning<2, 1>(size, {p}, {0});
+      auto cols = bulk::block_partitioning<2, 1>(size, {p}, {1});
+
+      auto xs = bulk::partitioned_array<size_t, 2>(world, block);
+      auto ys = bulk::partitioned_array<size_t, 2>(world, cyclic);
+      auto zs = bulk::partitioned_array<size_t, 2, 1>(world, rows);
+      auto ws = bulk::partitioned_array<size_t, 2, 1>(world, cols);
+      xs.for_each([&](auto index, auto& x) {
+        x = bulk::util::flatten<2>(size, index);
+      });
+
+      bulk::redistribute(xs, ys);
+      auto to_cyclic = holds_global(ys);
+      bulk::redistribute(ys, zs);
+      auto to_rows = holds_global(zs);
+      bulk::redistribute(zs, ws);
+      auto transposed = holds_global(ws);
+      BULK_CHECK(to_cyclic, "redistributes block to cyclic");
+      BULK_CHECK(to_rows, "redistributes cyclic to block");
+      BULK_CHECK(transposed, "redistributes block to transposed block");
+
+      if (p == 4) {
+        using dir = bulk::util::binary_tree<bulk::util::split>::dir;
+        auto splits =
+            bulk::util::binary_tree<bulk::util::split>(bulk::util::split{0, 3});
+        auto root = splits.root.get();
+        splits.add(root, dir::left, bulk::util::split{1, 1});
+        splits.add(root, dir::right, bulk::util::split{1, 2});
+        auto tree = bulk::tree_partitioning<2>(size, 4, std::move(splits));
+        auto vs = bulk::partitioned_array<size_t, 2, 1>(world, tree);
+
+        bulk::redistribute(ws, vs);
+        auto to_tree = holds_global(vs);
+        bulk::redistribute(vs, xs);
+        auto from_tree = holds_global(xs);
+        BULK_CHECK(to_tree, "redistributes to a tree partitioning");
+        BULK_CHECK(from_tree, "redistributes from a tree partitioning");
+      }
+    }
+
     BULK_SECTION("Irregular block partitioning") {
       auto part = bulk::block_partitioning<1>(5, 4);
       BULK_CHECK(part.local_count(0) == 2, "large block comes first");
@@ -172,5 +432,224 @@ void test_partitioning() {
       BULK_CHECK(part.global(0, 3) == 4,
                  "global: other processors have one element (4)");
     }
+
+    BULK_SECTION("Halo exchange") {
+      auto N = (size_t)sqrt(p);
+      auto size = bulk::index_type<2>{3 * N + 1, 2 * N + 1};
+      auto part = bulk::block_partitioning<2>(size, {N, N});
+      auto origin = part.origin(s);
+      auto local = part.local_size(s);
+
+      for (auto corners : {true, false}) {
+        auto halo = bulk::halo_exchange<int, 2>(world, part, 1, corners);
+        auto u = halo.field();
+        for (size_t j = 0; j < local[1]; ++j) {
+          for (size_t i = 0; i < local[0]; ++i) {
+            u[halo.index({i + 1, j + 1})] =
+                bulk::util::flatten<2>(size, {origin[0] + i, origin[1] + j}) +
+                1;
+          }
+        }
+        halo.exchange(u);
+
+        auto correct = true;
+        auto shape = halo.shape();
+        for (size_t j = 0; j < shape[1]; ++j) {
+          for (size_t i = 0; i < shape[0]; ++i) {
+            // the global position of the padded cell, shifted by one
+            auto x = origin[0] + i;
+            auto y = origin[1] + j;
+            auto ghost_x = i == 0 || i == shape[0] - 1;
+            auto ghost_y = j == 0 || j == shape[1] - 1;
+            auto expected = 0;
+            if (x >= 1 && x <= size[0] && y >= 1 && y <= size[1] &&
+                (corners || !(ghost_x && ghost_y))) {
+              expected = bulk::util::flatten<2>(size, {x - 1, y - 1}) + 1;
+            }
+            correct = correct && u[halo.index({i, j})] == expected;
+          }
+        }
+        BULK_CHECK(correct, "exchanges ghost cells");
+      }
+
+      auto halo = bulk::halo_exchange<int, 2>(world, part, 1);
+      auto faces = bulk::halo_exchange<int, 2>(world, part, 1, false);
+      auto m = part.multi_rank(s);
+      size_t below = (m[0] > 0) + (m[1] > 0);
+      size_t above = (m[0] + 1 < N) + (m[1] + 1 < N);
+      BULK_CHECK(faces.regions() == below + above, "sends only faces");
+      BULK_CHECK(halo.regions() >= faces.regions(), "also sends corners");
+    }
+
+    BULK_SECTION("Slices partitioning") {
+      // Slices of sizes 1, 2, ..., N along the first axis, and N, ..., 1
+      // along the second
+      auto boundaries = std::array<std::vector<size_t>, 2>{};
+      for (size_t i = 0; i <= N; ++i) {
+        boundaries[0].push_back(i * (i + 1) / 2);
+        boundaries[1].push_back(i * N - i * (i - 1) / 2);
+      }
+      auto part = bulk::slices_partitioning<2>(boundaries);
+      auto size = part.global_size();
+      auto correct = part.grid() == bulk::index_type<2>{N, N};
+      auto xs = std::vector<bulk::index_type<2>>{};
+      auto owners = std::vector<int>{};
+      for (size_t i = 0; i < size[0] * size[1]; ++i) {
+        auto x = bulk::util::unflatten<2>(size, i);
+        auto t = part.multi_owner(x);
+        auto local = part.local(x);
+        for (int d = 0; d < 2; ++d) {
+          correct = correct && boundaries[d][t[d]] <= x[d] &&
+                    x[d] < boundaries[d][t[d] + 1] &&
+                    local[d] == x[d] - boundaries[d][t[d]];
+        }
+        correct = correct && part.global(local, t) == x;
+        xs.push_back(x);
+        owners.push_back(part.owner(x));
+      }
+      auto batch = std::vector<int>(xs.size());
+      part.owner_batch(xs, batch);
+      BULK_CHECK(correct, "computes owners and local indices of slices");
+      BULK_CHECK(batch == owners, "computes owners of a batch of slices");
+
+      auto empty =
+          bulk::slices_partitioning<1>({std::vector<size_t>{0, 2, 2, 5}});
+      BULK_CHECK(empty.owner(2) == 2 && empty.local_size(1)[0] == 0,
+                 "supports empty slices");
+
+      auto block = bulk::block_partitioning<2>(size, {N, N});
+      auto ys = bulk::partitioned_array<size_t, 2>(world, block);
+      auto zs = bulk::partitioned_array<size_t, 2>(world, part);
+      ys.for_each([&](auto index, auto& y) {
+        y = bulk::util::flatten<2>(size, index);
+      });
+      bulk::redistribute(ys, zs);
+      auto moved = true;
+      zs.for_each([&](auto index, auto z) {
+        moved = moved && z == bulk::util::flatten<2>(size, index);
+      });
+      BULK_CHECK(moved, "redistributes to a slices partitioning");
+    }
+
+    BULK_SECTION("Space-filling-curve partitioning") {
+      auto size = bulk::index_type<3>{13, 7, 5};
+      auto correct = true;
+      auto balanced = true;
+      for (auto curve : {bulk::sfc_curve::morton, bulk::sfc_curve::hilbert}) {
+        auto part = bulk::sfc_partitioning<3>(size, p, curve);
+        auto seen = std::vector<std::vector<bool>>(p);
+        for (size_t t = 0; t < p; ++t) {
+          seen[t].resize(part.local_count(t));
+          balanced = balanced && part.local_count(t) == 455 * (t + 1) / p -
+                                                            455 * t / p;
+        }
+        for (size_t i = 0; i < 13 * 7 * 5; ++i) {
+          auto x = bulk::util::unflatten<3>(size, i);
+          auto t = part.owner(x);
+          auto local = part.local(x);
+          auto in_range = local[0] < seen[t].size();
+          correct = correct && in_range && !seen[t][local[0]] &&
+                    part.global(local, t) == x;
+          if (in_range) {
+            seen[t][local[0]] = true;
+          }
+        }
+      }
+      BULK_CHECK(correct, "maps between global and local indices");
+      BULK_CHECK(balanced, "divides the elements equally");
+
+      // Consecutive elements along the Hilbert curve are neighbours
+      auto adjacent = true;
+      for (std::uint64_t k = 0; k + 1 < 8 * 8 * 8; ++k) {
+        auto x = bulk::util::hilbert_decode<3>(k, 3);
+        auto y = bulk::util::hilbert_decode<3>(k + 1, 3);
+        size_t distance = 0;
+        for (int d = 0; d < 3; ++d) {
+          distance += x[d] > y[d] ? x[d] - y[d] : y[d] - x[d];
+        }
+        adjacent = adjacent && distance == 1 &&
+                   bulk::util::hilbert_encode<3>(x, 3) == k &&
+                   bulk::util::morton_encode<3>(
+                       bulk::util::morton_decode<3>(k)) == k;
+      }
+      BULK_CHECK(adjacent, "encodes along a continuous Hilbert curve");
+
+      auto block = bulk::block_partitioning<3, 1>(size, {p});
+      auto sfc = bulk::sfc_partitioning<3>(size, p);
+      auto xs = bulk::partitioned_array<size_t, 3, 1>(world, block);
+      auto ys = bulk::partitioned_array<size_t, 3, 1>(world, sfc);
+      xs.for_each([&](auto index, auto& x) {
+        x = bulk::util::flatten<3>(size, index);
+      });
+      bulk::redistribute(xs, ys);
+      auto moved = true;
+      ys.for_each([&](auto index, auto x) {
+        moved = moved && x == bulk::util::flatten<3>(size, index);
+      });
+      BULK_CHECK(moved, "redistributes to a space-filling-curve partitioning");
+    }
+
+    BULK_SECTION("Recursive coordinate bisection") {
+      auto size = bulk::index_type<2>{40, 30};
+      // The cells are dealt cyclically, with a heavy block of 10 x 10 cells
+      auto points = std::vector<bulk::index_type<2>>{};
+      for (size_t i = s; i < 40 * 30; i += p) {
+        points.push_back(bulk::util::unflatten<2>(size, i));
+      }
+      auto weights = std::vector<double>{};
+      auto weigh = [&](size_t x0, size_t y0) {
+        weights.clear();
+        for (auto x : points) {
+          auto heavy = x[0] >= x0 && x[0] < x0 + 10 && x[1] >= y0 &&
+                       x[1] < y0 + 10;
+          weights.push_back(heavy ? 20.0 : 1.0);
+        }
+      };
+      auto imbalance = [&](auto& part) {
+        return bulk::load_imbalance<2>(world, part, points, weights);
+      };
+      auto same = [&](auto& lhs, auto& rhs) {
+        for (size_t i = 0; i < 40 * 30; ++i) {
+          auto x = bulk::util::unflatten<2>(size, i);
+          if (lhs.owner(x) != rhs.owner(x)) {
+            return false;
+          }
+        }
+        return true;
+      };
+
+      weigh(0, 0);
+      auto part = bulk::rcb_partitioning<2>(world, size, points, weights);
+      size_t count = 0;
+      for (size_t t = 0; t < p; ++t) {
+        count += part.local_count(t);
+      }
+      auto blocks = bulk::block_partitioning<2, 1>(size, {p});
+      auto balanced = imbalance(part);
+      auto unbalanced = imbalance(blocks);
+      BULK_CHECK(part.grid()[0] == p && count == 40 * 30,
+                 "bisects the volume over all processors");
+      BULK_CHECK(balanced < 1.3 && balanced < unbalanced,
+                 "balances the weights");
+
+      auto cells = bulk::partitioned_array<double, 2, 1>(world, blocks);
+      cells.for_each([](auto x, auto& w) {
+        w = x[0] < 10 && x[1] < 10 ? 20.0 : 1.0;
+      });
+      auto from_cells = bulk::rcb_partitioning(cells);
+      auto agree = same(part, from_cells);
+      BULK_CHECK(agree, "bisects the weights of a partitioned array");
+
+      auto kept = bulk::rcb_rebalance<2>(world, part, points, weights);
+      auto unchanged = same(part, kept);
+      BULK_CHECK(unchanged, "keeps balanced splits");
+
+      weigh(25, 15);
+      auto drifted = imbalance(part);
+      auto rebalanced = bulk::rcb_rebalance<2>(world, part, points, weights);
+      auto after = imbalance(rebalanced);
+      BULK_CHECK(after < 1.3 && after < drifted,
+                 "rebalances drifted weights");
+    }
   });
 }